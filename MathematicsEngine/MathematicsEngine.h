@@ -1,14 +1,18 @@
 ﻿#ifndef MATHEMATICS_ENGINE_H_
 #define MATHEMATICS_ENGINE_H_
 
+#include <cmath>
+#include <functional>
 #include <iostream>
+#include <type_traits>
+#include <vector>
 #include <immintrin.h>
 
 struct alignas(64) Matrix33 {
 	float m[10];
-	Matrix33() : m{ 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0 } {}
-	Matrix33(float x) : m{ x, x, x, x, x, x, x, x, x, 0.0 } {}
-	Matrix33(float m00, float m01, float m02,
+	constexpr Matrix33() : m{ 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0 } {}
+	constexpr Matrix33(float x) : m{ x, x, x, x, x, x, x, x, x, 0.0 } {}
+	constexpr Matrix33(float m00, float m01, float m02,
 		float m10, float m11, float m12,
 		float m20, float m21, float m22)
 		: m{ m00, m01, m02, m10, m11, m12, m20, m21, m22, 0.0 } {}
@@ -16,36 +20,291 @@ struct alignas(64) Matrix33 {
 
 struct alignas(64) Matrix44 {
 	float m[16];
-	Matrix44() : m{ 0.0f } {}
-	Matrix44(float m0, float m1, float m2, float m3,
+	constexpr Matrix44() : m{ 0.0f } {}
+	constexpr Matrix44(float m0, float m1, float m2, float m3,
 		float m4, float m5, float m6, float m7,
 		float m8, float m9, float m10, float m11,
 		float m12, float m13, float m14, float m15)
 		:m{ m0, m1, m2, m3, m4, m5, m6, m7, m8, m9, m10, m11, m12, m13, m14, m15 } {}
 };
 
+// A 4x4 matrix stored column by column, m[0] to m[3] is the first column. This is the layout GPU
+// APIs expect, and it lets a matrix-vector product broadcast the vector against the columns
+// directly instead of transposing the rows first.
+struct alignas(64) Matrix44ColumnMajor {
+	float m[16];
+	constexpr Matrix44ColumnMajor() : m{ 0.0f } {}
+	// Elements are given in storage order, one column after another
+	constexpr Matrix44ColumnMajor(float m0, float m1, float m2, float m3,
+		float m4, float m5, float m6, float m7,
+		float m8, float m9, float m10, float m11,
+		float m12, float m13, float m14, float m15)
+		:m{ m0, m1, m2, m3, m4, m5, m6, m7, m8, m9, m10, m11, m12, m13, m14, m15 } {}
+};
+
+// Views of the storage of a matrix in one layout as its transpose in the other, without copying.
+// A view only holds a pointer to the 16 floats of the viewed matrix, so writes through the view
+// are seen through the matrix and the other way round. The view must not outlive the matrix.
+template <class Float>
+struct Matrix44View {
+	Float* m;
+	explicit constexpr Matrix44View(Float* m) : m(m) {}
+	constexpr Matrix44View(const Matrix44View<float>& view) requires std::is_const_v<Float> : m(view.m) {}
+};
+
+template <class Float>
+struct Matrix44ColumnMajorView {
+	Float* m;
+	explicit constexpr Matrix44ColumnMajorView(Float* m) : m(m) {}
+	constexpr Matrix44ColumnMajorView(const Matrix44ColumnMajorView<float>& view) requires std::is_const_v<Float> : m(view.m) {}
+};
+
+inline Matrix44ColumnMajorView<const float> transposed_view(const Matrix44& A) { return Matrix44ColumnMajorView<const float>(A.m); }
+inline Matrix44ColumnMajorView<float> transposed_view(Matrix44& A) { return Matrix44ColumnMajorView<float>(A.m); }
+inline Matrix44View<const float> transposed_view(const Matrix44ColumnMajor& A) { return Matrix44View<const float>(A.m); }
+inline Matrix44View<float> transposed_view(Matrix44ColumnMajor& A) { return Matrix44View<float>(A.m); }
+
 struct alignas(16) Vector4 {
 	float x, y, z, w;
-	Vector4() : x(0.0f), y(0.0f), z(0.0f), w(0.0f) {}
-	Vector4(float x, float y, float z, float w)
+	constexpr Vector4() : x(0.0f), y(0.0f), z(0.0f), w(0.0f) {}
+	constexpr Vector4(float x, float y, float z, float w)
 		: x(x), y(y), z(z), w(w) {}
 };
 
+// Selects how reciprocals and reciprocal square roots are computed by inverse and normalize.
+//  Exact       - _mm_div_ps / _mm_sqrt_ps, correctly rounded.
+//  Refined     - _mm_rcp_ps / _mm_rsqrt_ps followed by one Newton-Raphson step. Relative error
+//                of the reciprocal is at most 1e-6.
+//  Approximate - _mm_rcp_ps / _mm_rsqrt_ps alone. Relative error of the reciprocal is at most
+//                1.5 * 2^-12 (about 3.7e-4).
+// The error of an inverse or normalized vector is that of the reciprocal plus the rounding of
+// the exact path.
+enum class Precision {
+	Exact,
+	Refined,
+	Approximate
+};
+
+// Selects how the reductions sum their inputs.
+//  Naive    - plain running sums, the error grows linearly with the number of points.
+//  Kahan    - compensated sums within each thread's range, the error does not grow with the
+//             number of points in a range. The few per-range and per-lane partial sums are then
+//             added without compensation.
+//  Pairwise - block sums merged pairwise, the error grows with the log of the number of points.
+enum class Summation {
+	Naive,
+	Kahan,
+	Pairwise
+};
+
+struct alignas(16) Vector3 {
+	float x, y, z;
+	constexpr Vector3() : x(0.0f), y(0.0f), z(0.0f) {}
+	constexpr Vector3(float x, float y, float z)
+		: x(x), y(y), z(z) {}
+};
+
+// Structure of arrays view over a batch of Vector3, the i-th vector is (x[i], y[i], z[i]).
+// The arrays are not owned and need no particular alignment.
+struct Vector3SoA {
+	float* x;
+	float* y;
+	float* z;
+	Vector3SoA() : x(nullptr), y(nullptr), z(nullptr) {}
+	Vector3SoA(float* x, float* y, float* z)
+		: x(x), y(y), z(z) {}
+};
+
+// Read only form of Vector3SoA for the inputs of the batched kernels, so that constant arrays can be
+// passed. A Vector3SoA converts to it implicitly.
+struct Vector3SoAConst {
+	const float* x;
+	const float* y;
+	const float* z;
+	Vector3SoAConst() : x(nullptr), y(nullptr), z(nullptr) {}
+	Vector3SoAConst(const float* x, const float* y, const float* z)
+		: x(x), y(y), z(z) {}
+	Vector3SoAConst(const Vector3SoA& vectors)
+		: x(vectors.x), y(vectors.y), z(vectors.z) {}
+};
+
+// The bones influencing a skinned vertex and their weights, unused influences have zero weight.
+struct alignas(16) SkinWeights {
+	int bone[4];
+	float weight[4];
+	SkinWeights() : bone{ 0, 0, 0, 0 }, weight{ 0.0f, 0.0f, 0.0f, 0.0f } {}
+	SkinWeights(int bone0, int bone1, int bone2, int bone3, float weight0, float weight1, float weight2, float weight3)
+		: bone{ bone0, bone1, bone2, bone3 }, weight{ weight0, weight1, weight2, weight3 } {}
+};
+
+struct Viewport {
+	float x, y, width, height, min_depth, max_depth;
+	Viewport() : x(0.0f), y(0.0f), width(0.0f), height(0.0f), min_depth(0.0f), max_depth(1.0f) {}
+	Viewport(float x, float y, float width, float height, float min_depth = 0.0f, float max_depth = 1.0f)
+		: x(x), y(y), width(width), height(height), min_depth(min_depth), max_depth(max_depth) {}
+};
+
+// Set in the clip flags of a projected vertex for each clip space plane it lies outside of.
+enum ClipFlags {
+	CLIP_LEFT = 1 << 0,   // x < -w
+	CLIP_BOTTOM = 1 << 1, // y < -w
+	CLIP_NEAR = 1 << 2,   // z < -w
+	CLIP_RIGHT = 1 << 3,  // x > w
+	CLIP_TOP = 1 << 4,    // y > w
+	CLIP_FAR = 1 << 5,    // z > w
+	CLIP_BEHIND = 1 << 6  // w <= 0, the vertex is at or behind the eye and cannot be divided by w
+};
+
 void add(Matrix33& out, const Matrix33& A, const Matrix33& B);
-void transpose(Matrix33& out, Matrix33& in);
+void transpose(Matrix33& out, const Matrix33& in);
 void multiply(Matrix33& out, const Matrix33& A, const Matrix33& B);
 void multiply(Matrix33& out, const Matrix33& A, float scalar);
-void inverse(Matrix33& out, const Matrix33& A);
+void inverse(Matrix33& out, const Matrix33& A, Precision precision = Precision::Exact);
 void print(Matrix33& A);
 
 void transpose(Matrix44& out, const Matrix44& A);
-void inverse(Matrix44& out, const Matrix44& A);
+void inverse(Matrix44& out, const Matrix44& A, Precision precision = Precision::Exact);
 void multiply(Matrix44& out, const Matrix44& A, const Matrix44& B);
 void multiply(Vector4& out, const Matrix44& A, const Vector4& x);
 void print(const Matrix44& matrix);
 
+// Copies a matrix into the other layout, the result is the same matrix with its storage transposed
+void convert(Matrix44ColumnMajor& out, const Matrix44& A);
+void convert(Matrix44& out, const Matrix44ColumnMajor& A);
+
+void transpose(Matrix44ColumnMajor& out, const Matrix44ColumnMajor& A);
+void inverse(Matrix44ColumnMajor& out, const Matrix44ColumnMajor& A, Precision precision = Precision::Exact);
+void multiply(Matrix44ColumnMajor& out, const Matrix44ColumnMajor& A, const Matrix44ColumnMajor& B);
+void multiply(Vector4& out, const Matrix44ColumnMajor& A, const Vector4& x);
+void multiply_batch(Vector4* out, const Matrix44ColumnMajor& A, const Vector4* vectors, int num_vectors);
+
+// The kernels above reading and writing through views, so that a matrix can be used as its transpose
+void transpose(Matrix44View<float> out, Matrix44View<const float> A);
+void inverse(Matrix44View<float> out, Matrix44View<const float> A, Precision precision = Precision::Exact);
+void multiply(Matrix44View<float> out, Matrix44View<const float> A, Matrix44View<const float> B);
+void multiply(Vector4& out, Matrix44View<const float> A, const Vector4& x);
+void multiply_batch(Vector4* out, Matrix44View<const float> A, const Vector4* vectors, int num_vectors);
+void transpose(Matrix44ColumnMajorView<float> out, Matrix44ColumnMajorView<const float> A);
+void inverse(Matrix44ColumnMajorView<float> out, Matrix44ColumnMajorView<const float> A, Precision precision = Precision::Exact);
+void multiply(Matrix44ColumnMajorView<float> out, Matrix44ColumnMajorView<const float> A, Matrix44ColumnMajorView<const float> B);
+void multiply(Vector4& out, Matrix44ColumnMajorView<const float> A, const Vector4& x);
+void multiply_batch(Vector4* out, Matrix44ColumnMajorView<const float> A, const Vector4* vectors, int num_vectors);
+
+void multiply_batch(Vector4* out, const Matrix44& A, const Vector4* vectors, int num_vectors);
+
+// Transforms each vertex by the model-view-projection matrix, divides by w and maps the result
+// onto the viewport in a single pass. out holds the screen space x and y, the depth mapped to
+// [min_depth, max_depth] and 1/w. clip_flags receives the ClipFlags of each vertex, out is only
+// meaningful for vertices whose flags are zero.
+void project_batch(Vector4* out, unsigned char* clip_flags, const Matrix44& mvp, const Vector4* vertices, int num_vertices, const Viewport& viewport);
+
 float dot(const Vector4& A, const Vector4& B);
 void dot_batch(float* out, const Vector4& A, Vector4* vectors, int num_vectors);
+void normalize(Vector4& out, const Vector4& A, Precision precision = Precision::Exact);
+void normalize_batch(Vector4* out, const Vector4* vectors, int num_vectors, Precision precision = Precision::Exact);
+
+float dot(const Vector3& A, const Vector3& B);
+void cross(Vector3& out, const Vector3& A, const Vector3& B);
+float length(const Vector3& A);
+void normalize(Vector3& out, const Vector3& A, Precision precision = Precision::Exact);
+void lerp(Vector3& out, const Vector3& A, const Vector3& B, float t);
+void multiply(Vector3& out, const Matrix33& A, const Vector3& x);
+
+// Batched Vector3 kernels, eight vectors per AVX iteration. out may alias the inputs. To
+// transform normals pass the inverse transpose of the matrix to multiply_batch.
+void cross_batch(const Vector3SoA& out, const Vector3SoAConst& A, const Vector3SoAConst& B, int num_vectors);
+void length_batch(float* out, const Vector3SoAConst& vectors, int num_vectors);
+void normalize_batch(const Vector3SoA& out, const Vector3SoAConst& vectors, int num_vectors, Precision precision = Precision::Exact);
+void lerp_batch(const Vector3SoA& out, const Vector3SoAConst& A, const Vector3SoAConst& B, float t, int num_vectors);
+void multiply_batch(const Vector3SoA& out, const Matrix33& A, const Vector3SoAConst& vectors, int num_vectors);
+
+// Linear blend skinning. Each vertex is transformed by the weighted sum of the matrices of its
+// bones, taken from the palette of num_bones matrices. Normals are transformed by the same blended
+// matrix with w = 0, which is correct as long as the bones carry no non-uniform scale. Normals are
+// only skinned when both normals and out_normals are non-null, so either may be null to skin
+// positions only.
+void skin_batch(Vector4* out_positions, Vector4* out_normals, const Matrix44* bones, int num_bones,
+	const SkinWeights* weights, const Vector4* positions, const Vector4* normals, int num_vertices, int num_threads = 1);
+
+// Single pass reductions over a point set, partial results of each thread are combined in order
+// so the result does not depend on scheduling. covariance is the population covariance of the
+// x, y and z components and also returns the mean of the points.
+void bounds(Vector4& min, Vector4& max, const Vector4* points, int num_points, int num_threads = 1);
+void sum(Vector4& out, const Vector4* points, int num_points, Summation summation = Summation::Naive, int num_threads = 1);
+void mean(Vector4& out, const Vector4* points, int num_points, Summation summation = Summation::Naive, int num_threads = 1);
+void covariance(Matrix33& out, Vector4& mean, const Vector4* points, int num_points, Summation summation = Summation::Naive, int num_threads = 1);
+
+// RUNTIME TELEMETRY
+//
+// When the library is built with MATHEMATICS_ENGINE_TELEMETRY defined (the CMake option of the
+// same name) every batch kernel, reduction, skin_batch and Pipeline::run counts its calls, the
+// elements it processed and its latency in TSC ticks, on counters owned by the calling thread.
+// Kernels on a single matrix or vector are not instrumented, reading the TSC costs several times
+// more than they do. Kernels called by another kernel, also on the threads it starts, are not
+// recorded, so only the calls made by the user are counted and their time is counted once.
+// Without the option the instrumentation compiles away and snapshots still have an entry per
+// Kernel, with every count at zero.
+enum class Kernel {
+	MultiplyBatch33, MultiplyBatch44, ProjectBatch, MultiplyBatchColumnMajor,
+	DotBatch4, NormalizeBatch4,
+	CrossBatch3, LengthBatch3, NormalizeBatch3, LerpBatch3,
+	SkinBatch, PipelineRun, Bounds, Sum, Mean, Covariance,
+	Count
+};
+
+struct KernelTelemetry {
+	static const int num_buckets = 32;
+
+	const char* name;
+	unsigned long long calls;
+	unsigned long long elements;
+	unsigned long long ticks;
+	unsigned long long histogram[num_buckets]; // histogram[b] counts calls taking [2^b, 2^(b+1)) ticks, 0 and 1 tick go to bucket 0
+};
+
+bool telemetry_enabled();
+// Fills out with one entry per Kernel, summed over all threads including those that have exited,
+// counted from the last telemetry_reset.
+void telemetry_snapshot(std::vector<KernelTelemetry>& out);
+void telemetry_reset();
+// Writes a snapshot in the Prometheus text exposition format, kernels that were not called are left out.
+void telemetry_export(std::ostream& out);
+
+// Splits [0, count) into one contiguous range per thread and calls body(begin, end) for each.
+// With num_threads <= 1 the body is called once on the calling thread.
+void parallel_for(int count, int num_threads, const std::function<void(int begin, int end)>& body);
+// The length of the ranges parallel_for makes, range k is [k * length, (k + 1) * length) clipped
+// to count. Callers can use begin / length to give every range its own slot.
+int parallel_for_range(int count, int num_threads);
+
+// A pipeline stage processes vectors[begin, end) in place. Stages are called once per chunk of at
+// most chunk_size vectors, except for the first stage: while prefetching is on it is called once
+// per prefetch_step vectors, 512 calls per chunk. A stage must give the same result whatever the
+// ranges it is given, and any setup it does per call, such as the transform stage arranging its
+// matrix into columns, is repeated for each range.
+typedef std::function<void(Vector4* vectors, int begin, int end)> PipelineStage;
+
+// Chains batch operations so that they are run chunk by chunk over a Vector4 array. Each chunk
+// is sized to stay in L2 while every stage is applied to it, so the array is streamed from
+// memory once rather than once per operation. Stages keep references to their arguments, which
+// must outlive the pipeline.
+class Pipeline {
+private:
+	std::vector<PipelineStage> stages;
+	int prefetch_distance = 256;
+
+public:
+	static const int chunk_size = 8192; // 128 KiB of Vector4, half of a typical L2
+	static const int prefetch_step = 16; // Vector4 per step of the first stage, four cache lines
+
+	Pipeline& transform(const Matrix44& A);
+	Pipeline& normalize(Precision precision = Precision::Exact);
+	Pipeline& dot(float* out, const Vector4& A);
+	Pipeline& stage(const PipelineStage& stage);
+	// Sets how many vectors ahead of the first stage are prefetched, 0 turns prefetching off.
+	Pipeline& prefetch(int distance);
+	void run(Vector4* vectors, int num_vectors, int num_threads = 1) const;
+};
 
 
 __m128 matrix_times_matrix_2x2(__m128 vec1, __m128 vec2);
@@ -53,4 +312,177 @@ __m128 determinant_2x2(__m128 matrix);
 __m128 adjugate_times_matrix(__m128 vec1, __m128 vec2);
 __m128 matrix_times_adjugate(__m128 vec1, __m128 vec2);
 
+// CONSTEXPR BUILDERS AND OPERATIONS
+//
+// These are evaluated by the compiler when used in a constant expression, so that a chain of
+// constant transforms folds to a single matrix. At runtime the value returning operations call
+// the SIMD kernels above instead of the scalar code.
+
+// Sine and cosine by Taylor series after reducing the angle to [-pi, pi], used during constant
+// evaluation where std::sin and std::cos are not available.
+constexpr float sine(float radians) {
+	if (!std::is_constant_evaluated()) {
+		return std::sin(radians);
+	}
+
+	const double two_pi = 6.28318530717958647692;
+	double x = radians;
+	double turns = x / two_pi;
+	long long whole_turns = (long long)(turns < 0.0 ? turns - 0.5 : turns + 0.5);
+	x -= two_pi * (double)whole_turns;
+
+	double term = x;
+	double sum = x;
+	for (int n = 1; n < 12; n++) {
+		term *= -x * x / ((2.0 * n) * (2.0 * n + 1.0));
+		sum += term;
+	}
+	return (float)sum;
+}
+
+constexpr float cosine(float radians) {
+	if (!std::is_constant_evaluated()) {
+		return std::cos(radians);
+	}
+	// cos(x) = sin(x + pi/2)
+	return sine((float)((double)radians + 1.57079632679489661923));
+}
+
+constexpr Matrix33 identity33() {
+	return Matrix33(1.0f, 0.0f, 0.0f,
+		0.0f, 1.0f, 0.0f,
+		0.0f, 0.0f, 1.0f);
+}
+
+constexpr Matrix44 identity44() {
+	return Matrix44(1.0f, 0.0f, 0.0f, 0.0f,
+		0.0f, 1.0f, 0.0f, 0.0f,
+		0.0f, 0.0f, 1.0f, 0.0f,
+		0.0f, 0.0f, 0.0f, 1.0f);
+}
+
+constexpr Matrix44 translation(float x, float y, float z) {
+	return Matrix44(1.0f, 0.0f, 0.0f, x,
+		0.0f, 1.0f, 0.0f, y,
+		0.0f, 0.0f, 1.0f, z,
+		0.0f, 0.0f, 0.0f, 1.0f);
+}
+
+constexpr Matrix44 scaling(float x, float y, float z) {
+	return Matrix44(x, 0.0f, 0.0f, 0.0f,
+		0.0f, y, 0.0f, 0.0f,
+		0.0f, 0.0f, z, 0.0f,
+		0.0f, 0.0f, 0.0f, 1.0f);
+}
+
+// Rotations are counter-clockwise about the given axis, for column vectors
+constexpr Matrix44 rotation_x(float radians) {
+	float c = cosine(radians);
+	float s = sine(radians);
+	return Matrix44(1.0f, 0.0f, 0.0f, 0.0f,
+		0.0f, c, -s, 0.0f,
+		0.0f, s, c, 0.0f,
+		0.0f, 0.0f, 0.0f, 1.0f);
+}
+
+constexpr Matrix44 rotation_y(float radians) {
+	float c = cosine(radians);
+	float s = sine(radians);
+	return Matrix44(c, 0.0f, s, 0.0f,
+		0.0f, 1.0f, 0.0f, 0.0f,
+		-s, 0.0f, c, 0.0f,
+		0.0f, 0.0f, 0.0f, 1.0f);
+}
+
+constexpr Matrix44 rotation_z(float radians) {
+	float c = cosine(radians);
+	float s = sine(radians);
+	return Matrix44(c, -s, 0.0f, 0.0f,
+		s, c, 0.0f, 0.0f,
+		0.0f, 0.0f, 1.0f, 0.0f,
+		0.0f, 0.0f, 0.0f, 1.0f);
+}
+
+constexpr Matrix33 multiply(const Matrix33& A, const Matrix33& B) {
+	Matrix33 out;
+	if (std::is_constant_evaluated()) {
+		for (int row = 0; row < 3; row++) {
+			for (int col = 0; col < 3; col++) {
+				float sum = 0.0f;
+				for (int k = 0; k < 3; k++) {
+					sum += A.m[row * 3 + k] * B.m[k * 3 + col];
+				}
+				out.m[row * 3 + col] = sum;
+			}
+		}
+	}
+	else {
+		multiply(out, A, B);
+	}
+	return out;
+}
+
+constexpr Matrix33 transpose(const Matrix33& A) {
+	Matrix33 out;
+	if (std::is_constant_evaluated()) {
+		for (int row = 0; row < 3; row++) {
+			for (int col = 0; col < 3; col++) {
+				out.m[col * 3 + row] = A.m[row * 3 + col];
+			}
+		}
+	}
+	else {
+		transpose(out, A);
+	}
+	return out;
+}
+
+constexpr Matrix44 multiply(const Matrix44& A, const Matrix44& B) {
+	Matrix44 out;
+	if (std::is_constant_evaluated()) {
+		for (int row = 0; row < 4; row++) {
+			for (int col = 0; col < 4; col++) {
+				float sum = 0.0f;
+				for (int k = 0; k < 4; k++) {
+					sum += A.m[row * 4 + k] * B.m[k * 4 + col];
+				}
+				out.m[row * 4 + col] = sum;
+			}
+		}
+	}
+	else {
+		multiply(out, A, B);
+	}
+	return out;
+}
+
+constexpr Matrix44 transpose(const Matrix44& A) {
+	Matrix44 out;
+	if (std::is_constant_evaluated()) {
+		for (int row = 0; row < 4; row++) {
+			for (int col = 0; col < 4; col++) {
+				out.m[col * 4 + row] = A.m[row * 4 + col];
+			}
+		}
+	}
+	else {
+		transpose(out, A);
+	}
+	return out;
+}
+
+constexpr Vector4 multiply(const Matrix44& A, const Vector4& x) {
+	Vector4 out;
+	if (std::is_constant_evaluated()) {
+		out.x = A.m[0] * x.x + A.m[1] * x.y + A.m[2] * x.z + A.m[3] * x.w;
+		out.y = A.m[4] * x.x + A.m[5] * x.y + A.m[6] * x.z + A.m[7] * x.w;
+		out.z = A.m[8] * x.x + A.m[9] * x.y + A.m[10] * x.z + A.m[11] * x.w;
+		out.w = A.m[12] * x.x + A.m[13] * x.y + A.m[14] * x.z + A.m[15] * x.w;
+	}
+	else {
+		multiply(out, A, x);
+	}
+	return out;
+}
+
 #endif // MATHEMATICS_ENGINE_H_
\ No newline at end of file
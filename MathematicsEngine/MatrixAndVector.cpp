@@ -1,4 +1,59 @@
-﻿#include "MathematicsEngine.h"
+﻿#include <cmath>
+
+#include "MathematicsEngine.h"
+#include "Telemetry.h"
+
+inline __m128 reciprocal(__m128 x, Precision precision) {
+	if (precision == Precision::Exact) {
+		return _mm_div_ps(_mm_set1_ps(1.0f), x);
+	}
+
+	__m128 r = _mm_rcp_ps(x);
+	if (precision == Precision::Refined) {
+		// Newton-Raphson for f(r) = 1/r - x: r' = r * (2 - x * r)
+		__m128 refined = _mm_mul_ps(r, _mm_fnmadd_ps(x, r, _mm_set1_ps(2.0f)));
+
+		// The estimate is inf for 0 and for values below FLT_MIN, where the step gives
+		// inf * (2 - 0 * inf) = NaN, or an inf of the wrong sign for a denormal x. Lanes with
+		// an infinite estimate keep it, which matches the Exact result.
+		__m128 finite = _mm_cmplt_ps(_mm_andnot_ps(_mm_set1_ps(-0.0f), r), _mm_set1_ps(INFINITY));
+		r = _mm_blendv_ps(r, refined, finite);
+	}
+	return r;
+}
+
+inline __m128 reciprocal_sqrt(__m128 x, Precision precision) {
+	if (precision == Precision::Exact) {
+		return _mm_div_ps(_mm_set1_ps(1.0f), _mm_sqrt_ps(x));
+	}
+
+	__m128 r = _mm_rsqrt_ps(x);
+	if (precision == Precision::Refined) {
+		// Newton-Raphson for f(r) = 1/r^2 - x: r' = 0.5 * r * (3 - x * r * r)
+		__m128 half_r = _mm_mul_ps(_mm_set1_ps(0.5f), r);
+		__m128 refined = _mm_mul_ps(half_r, _mm_fnmadd_ps(_mm_mul_ps(x, r), r, _mm_set1_ps(3.0f)));
+
+		// As in reciprocal, an infinite estimate is kept rather than refined
+		__m128 finite = _mm_cmplt_ps(_mm_andnot_ps(_mm_set1_ps(-0.0f), r), _mm_set1_ps(INFINITY));
+		r = _mm_blendv_ps(r, refined, finite);
+	}
+	return r;
+}
+
+inline __m256 reciprocal_sqrt(__m256 x, Precision precision) {
+	if (precision == Precision::Exact) {
+		return _mm256_div_ps(_mm256_set1_ps(1.0f), _mm256_sqrt_ps(x));
+	}
+
+	__m256 r = _mm256_rsqrt_ps(x);
+	if (precision == Precision::Refined) {
+		__m256 half_r = _mm256_mul_ps(_mm256_set1_ps(0.5f), r);
+		__m256 refined = _mm256_mul_ps(half_r, _mm256_fnmadd_ps(_mm256_mul_ps(x, r), r, _mm256_set1_ps(3.0f)));
+		__m256 finite = _mm256_cmp_ps(_mm256_andnot_ps(_mm256_set1_ps(-0.0f), r), _mm256_set1_ps(INFINITY), _CMP_LT_OQ);
+		r = _mm256_blendv_ps(r, refined, finite);
+	}
+	return r;
+}
 
 void add(Matrix33& out, const Matrix33& A, const Matrix33& B) {
 	__m256 vec_a = _mm256_load_ps(&A.m[0]);
@@ -32,8 +87,8 @@ void multiply(Matrix33& out, const Matrix33& A, const Matrix33& B) {
 	// row_1 = [ b3 b4 b5 b6(junk) ]
 	// row_2 = [ b6 b7 b8 b9(junk) ]
 	__m128 row_0 = _mm_load_ps(&B.m[0]);
-	__m128 row_1 = _mm_load_ps(&B.m[3]);
-	__m128 row_2 = _mm_load_ps(&B.m[6]);
+	__m128 row_1 = _mm_loadu_ps(&B.m[3]);
+	__m128 row_2 = _mm_loadu_ps(&B.m[6]);
 
 	// a_00 = [ a0 a0 a0 a0(junk) ]
 	// a_01 = [ a1 a1 a1 a1(junk) ]
@@ -64,7 +119,7 @@ void multiply(Matrix33& out, const Matrix33& A, const Matrix33& B) {
 	__m128 c_row_1 = _mm_mul_ps(a_10, row_0);
 	c_row_1 = _mm_fmadd_ps(a_11, row_1, c_row_1);
 	c_row_1 = _mm_fmadd_ps(a_12, row_2, c_row_1);
-	_mm_store_ps(&out.m[3], c_row_1); // This store operation will overwrite the junk that is currently in m[3], and place new junk in m[6]
+	_mm_storeu_ps(&out.m[3], c_row_1); // This store operation will overwrite the junk that is currently in m[3], and place new junk in m[6]
 
 	__m128 a_20 = _mm_broadcast_ss(&A.m[6]);
 	__m128 a_21 = _mm_broadcast_ss(&A.m[7]);
@@ -73,7 +128,7 @@ void multiply(Matrix33& out, const Matrix33& A, const Matrix33& B) {
 	__m128 c_row_2 = _mm_mul_ps(a_20, row_0);
 	c_row_2 = _mm_fmadd_ps(a_21, row_1, c_row_2);
 	c_row_2 = _mm_fmadd_ps(a_22, row_2, c_row_2);
-	_mm_store_ps(&out.m[6], c_row_2); // This store operation will overwrite the junk that is currently in m[6], and place new junk in m[9] (which is unused)
+	_mm_storeu_ps(&out.m[6], c_row_2); // This store operation will overwrite the junk that is currently in m[6], and place new junk in m[9] (which is unused)
 
 }
 
@@ -86,23 +141,23 @@ void multiply(Matrix33& out, const Matrix33& A, float scalar) {
 
 }
 
-void transpose(Matrix33& out, Matrix33& in) {
+void transpose(Matrix33& out, const Matrix33& in) {
 	__m128 row_0 = _mm_load_ps(&in.m[0]); // a0 a1 a2 a3
-	__m128 row_1 = _mm_load_ps(&in.m[1]); // a1 a2 a3 a4
-	__m128 row_2 = _mm_load_ps(&in.m[2]); // a2 a3 a4 a5
-	__m128 row_3 = _mm_load_ps(&in.m[6]); // a6 a7 a8 a9
+	__m128 row_1 = _mm_loadu_ps(&in.m[1]); // a1 a2 a3 a4
+	__m128 row_2 = _mm_loadu_ps(&in.m[2]); // a2 a3 a4 a5
+	__m128 row_3 = _mm_loadu_ps(&in.m[6]); // a6 a7 a8 a9
 
 	// a0   a1   a2   a3       a0   a3   a6   (junk)
 	// a3   a4   a5   a6  -->  a1   a4   a7   (junk)
 	// a6   a7   a8   a9  -->  a2   a5   a8   (junk)
 
 	_mm_store_ps(&out.m[0], _mm_shuffle_ps(row_0, row_3, 0b00001100));  // returns [a0 a3 a6 a6]
-	_mm_store_ps(&out.m[3], _mm_shuffle_ps(row_1, row_3, 0b01011100));  // returns [a1 a4 a7 a7]
-	_mm_store_ps(&out.m[6], _mm_shuffle_ps(row_2, row_3, 0b10101100));  // returns [a2 a5 a8 a8]
+	_mm_storeu_ps(&out.m[3], _mm_shuffle_ps(row_1, row_3, 0b01011100));  // returns [a1 a4 a7 a7]
+	_mm_storeu_ps(&out.m[6], _mm_shuffle_ps(row_2, row_3, 0b10101100));  // returns [a2 a5 a8 a8]
 }
 
 
-void inverse(Matrix33& out, const Matrix33& A) {
+void inverse(Matrix33& out, const Matrix33& A, Precision precision) {
 	out.m[0] = A.m[4] * A.m[8] - A.m[5] * A.m[7]; // ei - fh 
 	out.m[3] = A.m[5] * A.m[6] - A.m[3] * A.m[8]; // -(di - fg)
 	out.m[6] = A.m[3] * A.m[7] - A.m[4] * A.m[6]; // dh - eg
@@ -114,7 +169,12 @@ void inverse(Matrix33& out, const Matrix33& A) {
 		out.m[5] = A.m[3] * A.m[2] - A.m[0] * A.m[5]; // -(af - cd)
 		out.m[7] = A.m[1] * A.m[6] - A.m[0] * A.m[7]; // -(ah - bg)
 		out.m[8] = A.m[0] * A.m[4] - A.m[1] * A.m[3]; // ae - bd
-		determinant = 1.0f / determinant;
+		if (precision == Precision::Exact) {
+			determinant = 1.0f / determinant;
+		}
+		else {
+			determinant = _mm_cvtss_f32(reciprocal(_mm_set1_ps(determinant), precision));
+		}
 		multiply(out, out, determinant);
 	}
 
@@ -131,12 +191,11 @@ void print(const Matrix33& A) {
 }
 
 
-void inverse(Matrix44& out, const Matrix44& A) {
-
-	__m128 row0 = _mm_load_ps(&A.m[0]);  // [a00, a01, a02, a03]
-	__m128 row1 = _mm_load_ps(&A.m[4]);  // [a10, a11, a12, a13]
-	__m128 row2 = _mm_load_ps(&A.m[8]);  // [a20, a21, a22, a23]
-	__m128 row3 = _mm_load_ps(&A.m[12]); // [a30, a31, a32, a33]
+inline void inverse_44(float* out, const float* A, Precision precision) {
+	__m128 row0 = _mm_load_ps(&A[0]);  // [a00, a01, a02, a03]
+	__m128 row1 = _mm_load_ps(&A[4]);  // [a10, a11, a12, a13]
+	__m128 row2 = _mm_load_ps(&A[8]);  // [a20, a21, a22, a23]
+	__m128 row3 = _mm_load_ps(&A[12]); // [a30, a31, a32, a33]
 
 	// 2x2 SUBMATRIX CREATION
 	__m128 sub_matrix_A = _mm_shuffle_ps(row0, row1, 0b01000100); // [a00, a10, a10, a11]
@@ -191,7 +250,13 @@ void inverse(Matrix44& out, const Matrix44& A) {
 
 	// RECONSTRUCT MATRIX TO GET RESULT
 	const __m128 adjugate_sign_mask = _mm_setr_ps(1.0f, -1.0f, -1.0f, 1.0f);
-	__m128 reciprocal_determinant = _mm_div_ps(adjugate_sign_mask, determinant);
+	__m128 reciprocal_determinant;
+	if (precision == Precision::Exact) {
+		reciprocal_determinant = _mm_div_ps(adjugate_sign_mask, determinant);
+	}
+	else {
+		reciprocal_determinant = _mm_mul_ps(adjugate_sign_mask, reciprocal(determinant, precision));
+	}
 
 	partial_inverse_A = _mm_mul_ps(partial_inverse_A, reciprocal_determinant);
 	partial_inverse_B = _mm_mul_ps(partial_inverse_B, reciprocal_determinant);
@@ -203,17 +268,25 @@ void inverse(Matrix44& out, const Matrix44& A) {
 	// [c0, c1, d0, d1]  -->  [c3, c1, d3, d1]
 	// [c2, c3, d2, d3]       [c2, c0, d2, d0]
 
-	_mm_store_ps(&out.m[0], _mm_shuffle_ps(partial_inverse_A, partial_inverse_B, 0b01110111));
-	_mm_store_ps(&out.m[4], _mm_shuffle_ps(partial_inverse_A, partial_inverse_B, 0b00100010));
-	_mm_store_ps(&out.m[8], _mm_shuffle_ps(partial_inverse_C, partial_inverse_D, 0b01110111));
-	_mm_store_ps(&out.m[12], _mm_shuffle_ps(partial_inverse_C, partial_inverse_D, 0b00100010));
+	_mm_store_ps(&out[0], _mm_shuffle_ps(partial_inverse_A, partial_inverse_B, 0b01110111));
+	_mm_store_ps(&out[4], _mm_shuffle_ps(partial_inverse_A, partial_inverse_B, 0b00100010));
+	_mm_store_ps(&out[8], _mm_shuffle_ps(partial_inverse_C, partial_inverse_D, 0b01110111));
+	_mm_store_ps(&out[12], _mm_shuffle_ps(partial_inverse_C, partial_inverse_D, 0b00100010));
 }
 
-void transpose(Matrix44& out, const Matrix44& A) {
-	__m128 row_0 = _mm_load_ps(&A.m[0]);  // a0   a1   a2   a3
-	__m128 row_1 = _mm_load_ps(&A.m[4]);  // a4   a5   a6   a7
-	__m128 row_2 = _mm_load_ps(&A.m[8]);  // a8   a9   a10  a11
-	__m128 row_3 = _mm_load_ps(&A.m[12]); // a12  a13  a14  a15
+void inverse(Matrix44& out, const Matrix44& A, Precision precision) {
+	inverse_44(out.m, A.m, precision);
+}
+
+void inverse(Matrix44View<float> out, Matrix44View<const float> A, Precision precision) {
+	inverse_44(out.m, A.m, precision);
+}
+
+inline void transpose_44(float* out, const float* A) {
+	__m128 row_0 = _mm_load_ps(&A[0]);  // a0   a1   a2   a3
+	__m128 row_1 = _mm_load_ps(&A[4]);  // a4   a5   a6   a7
+	__m128 row_2 = _mm_load_ps(&A[8]);  // a8   a9   a10  a11
+	__m128 row_3 = _mm_load_ps(&A[12]); // a12  a13  a14  a15
 
 	// a0   a1   a2   a3        a0   a4   a8   a12
 	// a4   a5   a6   a7   -->  a1   a5   a9   a13
@@ -227,10 +300,10 @@ void transpose(Matrix44& out, const Matrix44& A) {
 	__m128 row23_helper = _mm_unpacklo_ps(row_2, row_3); // returns [a8  a12  a9  a13]
 
 	// row0 = _mm_shuffle_ps([a0  a4  a1 a5], [a8  a12  a9  a13]) returns [a0 a4 a8 a12]
-	_mm_store_ps(&out.m[0], _mm_shuffle_ps(row01_helper, row23_helper, 0b01000100));
+	_mm_store_ps(&out[0], _mm_shuffle_ps(row01_helper, row23_helper, 0b01000100));
 
 	// row1 = _mm_shuffle_ps([a0  a4  a1 a5], [a8  a12  a9  a13]) returns [a1 a5 a9 a13]
-	_mm_store_ps(&out.m[4], _mm_shuffle_ps(row01_helper, row23_helper, 0b11101110));
+	_mm_store_ps(&out[4], _mm_shuffle_ps(row01_helper, row23_helper, 0b11101110));
 
 	// _mm_unpacklo_ps([a0   a1   a2   a3], [a4   a5   a6   a7]) returns  [a2  a6  a3  a7]
 	row01_helper = _mm_unpackhi_ps(row_0, row_1); // returns [a2  a6  a3  a7]
@@ -239,74 +312,90 @@ void transpose(Matrix44& out, const Matrix44& A) {
 	row23_helper = _mm_unpackhi_ps(row_2, row_3); // returns [a10  a14  a11  a15]
 
 	// row2 = _mm_shuffle_ps([a2  a6  a3  a7],  [a10  a14  a11  a15]) returns [a2 a6 a10 a14]
-	_mm_store_ps(&out.m[8], _mm_shuffle_ps(row01_helper, row23_helper, 0b01000100));
+	_mm_store_ps(&out[8], _mm_shuffle_ps(row01_helper, row23_helper, 0b01000100));
 
 	// row3 = _mm_shuffle_ps([a2  a6  a3  a7], [a10  a14  a11  a15]) returns [a3 a7 a11 a15]
-	_mm_store_ps(&out.m[12], _mm_shuffle_ps(row01_helper, row23_helper, 0b11101110));
+	_mm_store_ps(&out[12], _mm_shuffle_ps(row01_helper, row23_helper, 0b11101110));
 }
 
-void multiply(Matrix44& out, const Matrix44& A, const Matrix44& B) {
-	__m128 row_0 = _mm_load_ps(&B.m[0]);
-	__m128 row_1 = _mm_load_ps(&B.m[4]);
-	__m128 row_2 = _mm_load_ps(&B.m[8]);
-	__m128 row_3 = _mm_load_ps(&B.m[12]);
+void transpose(Matrix44& out, const Matrix44& A) {
+	transpose_44(out.m, A.m);
+}
+
+void transpose(Matrix44View<float> out, Matrix44View<const float> A) {
+	transpose_44(out.m, A.m);
+}
+
+inline void multiply_44(float* out, const float* A, const float* B) {
+	__m128 row_0 = _mm_load_ps(&B[0]);
+	__m128 row_1 = _mm_load_ps(&B[4]);
+	__m128 row_2 = _mm_load_ps(&B[8]);
+	__m128 row_3 = _mm_load_ps(&B[12]);
 
 	// OUTPUT ROW 0
-	__m128 a_00 = _mm_broadcast_ss(&A.m[0]);
-	__m128 a_01 = _mm_broadcast_ss(&A.m[1]);
-	__m128 a_02 = _mm_broadcast_ss(&A.m[2]);
-	__m128 a_03 = _mm_broadcast_ss(&A.m[3]);
+	__m128 a_00 = _mm_broadcast_ss(&A[0]);
+	__m128 a_01 = _mm_broadcast_ss(&A[1]);
+	__m128 a_02 = _mm_broadcast_ss(&A[2]);
+	__m128 a_03 = _mm_broadcast_ss(&A[3]);
 
 	__m128 out_row = _mm_mul_ps(a_00, row_0); // c_row_0 = [a00*b00, a00*b01, a00*b02, a00*b03] 
 	out_row = _mm_fmadd_ps(a_01, row_1, out_row); // c_row_0 = [a00*b00, a00*b01, a00*b02, a00*b03] + [a01*b10, a01*b11, a01*b12, a01*b13] 
 	out_row = _mm_fmadd_ps(a_02, row_2, out_row); // c_row_0 = [a00*b00+a01*b10, a00*b01+a01*b11, a00*b02+a01*b12, a00*b03+a01*b13] + [a02*b20, a02*b21, a02*b22, a02*b23] 
 	out_row = _mm_fmadd_ps(a_03, row_3, out_row);
 
-	_mm_store_ps(&out.m[0], out_row);
+	_mm_store_ps(&out[0], out_row);
 
 	// OUTPUT ROW 1
-	__m128 a_10 = _mm_broadcast_ss(&A.m[4]);
-	__m128 a_11 = _mm_broadcast_ss(&A.m[5]);
-	__m128 a_12 = _mm_broadcast_ss(&A.m[6]);
-	__m128 a_13 = _mm_broadcast_ss(&A.m[7]);
+	__m128 a_10 = _mm_broadcast_ss(&A[4]);
+	__m128 a_11 = _mm_broadcast_ss(&A[5]);
+	__m128 a_12 = _mm_broadcast_ss(&A[6]);
+	__m128 a_13 = _mm_broadcast_ss(&A[7]);
 
 	out_row = _mm_mul_ps(a_10, row_0);
 	out_row = _mm_fmadd_ps(a_11, row_1, out_row);
 	out_row = _mm_fmadd_ps(a_12, row_2, out_row);
 	out_row = _mm_fmadd_ps(a_13, row_3, out_row);
 
-	_mm_store_ps(&out.m[4], out_row);
+	_mm_store_ps(&out[4], out_row);
 
 	// OUTPUT ROW 2
-	__m128 a_20 = _mm_broadcast_ss(&A.m[8]);
-	__m128 a_21 = _mm_broadcast_ss(&A.m[9]);
-	__m128 a_22 = _mm_broadcast_ss(&A.m[10]);
-	__m128 a_23 = _mm_broadcast_ss(&A.m[11]);
+	__m128 a_20 = _mm_broadcast_ss(&A[8]);
+	__m128 a_21 = _mm_broadcast_ss(&A[9]);
+	__m128 a_22 = _mm_broadcast_ss(&A[10]);
+	__m128 a_23 = _mm_broadcast_ss(&A[11]);
 
 	out_row = _mm_mul_ps(a_20, row_0);
 	out_row = _mm_fmadd_ps(a_21, row_1, out_row);
 	out_row = _mm_fmadd_ps(a_22, row_2, out_row);
 	out_row = _mm_fmadd_ps(a_23, row_3, out_row);
-	_mm_store_ps(&out.m[8], out_row);
+	_mm_store_ps(&out[8], out_row);
 
 	// OUTPUT ROW 3
-	__m128 a_30 = _mm_broadcast_ss(&A.m[12]);
-	__m128 a_31 = _mm_broadcast_ss(&A.m[13]);
-	__m128 a_32 = _mm_broadcast_ss(&A.m[14]);
-	__m128 a_33 = _mm_broadcast_ss(&A.m[15]);
+	__m128 a_30 = _mm_broadcast_ss(&A[12]);
+	__m128 a_31 = _mm_broadcast_ss(&A[13]);
+	__m128 a_32 = _mm_broadcast_ss(&A[14]);
+	__m128 a_33 = _mm_broadcast_ss(&A[15]);
 
 	out_row = _mm_mul_ps(a_30, row_0);
 	out_row = _mm_fmadd_ps(a_31, row_1, out_row);
 	out_row = _mm_fmadd_ps(a_32, row_2, out_row);
 	out_row = _mm_fmadd_ps(a_33, row_3, out_row);
-	_mm_store_ps(&out.m[12], out_row);
+	_mm_store_ps(&out[12], out_row);
 }
 
-void multiply(Vector4& out, const Matrix44& A, const Vector4& x) {
-	__m128 row_0 = _mm_load_ps(&A.m[0]);  // [a0,  a1,  a2,  a3]
-	__m128 row_1 = _mm_load_ps(&A.m[4]);  // [a4,  a5,  a6,  a7]
-	__m128 row_2 = _mm_load_ps(&A.m[8]);  // [a8,  a9,  a10, a11]
-	__m128 row_3 = _mm_load_ps(&A.m[12]); // [a12, a13, a14, a15]
+void multiply(Matrix44& out, const Matrix44& A, const Matrix44& B) {
+	multiply_44(out.m, A.m, B.m);
+}
+
+void multiply(Matrix44View<float> out, Matrix44View<const float> A, Matrix44View<const float> B) {
+	multiply_44(out.m, A.m, B.m);
+}
+
+inline void multiply_vector_44(Vector4& out, const float* A, const Vector4& x) {
+	__m128 row_0 = _mm_load_ps(&A[0]);  // [a0,  a1,  a2,  a3]
+	__m128 row_1 = _mm_load_ps(&A[4]);  // [a4,  a5,  a6,  a7]
+	__m128 row_2 = _mm_load_ps(&A[8]);  // [a8,  a9,  a10, a11]
+	__m128 row_3 = _mm_load_ps(&A[12]); // [a12, a13, a14, a15]
 
 	__m128 row01_helper = _mm_unpacklo_ps(row_0, row_1);
 	__m128 row23_helper = _mm_unpacklo_ps(row_2, row_3);
@@ -339,6 +428,191 @@ void multiply(Vector4& out, const Matrix44& A, const Vector4& x) {
 	_mm_store_ps((float*) & out, out_vec);
 }
 
+void multiply(Vector4& out, const Matrix44& A, const Vector4& x) {
+	multiply_vector_44(out, A.m, x);
+}
+
+void multiply(Vector4& out, Matrix44View<const float> A, const Vector4& x) {
+	multiply_vector_44(out, A.m, x);
+}
+
+inline void multiply_batch_44(Vector4* out, const float* A, const Vector4* vectors, int num_vectors) {
+	// Same as multiply(Vector4&, const Matrix44&, const Vector4&), but the matrix is transposed
+	// into columns once for the whole batch rather than once per vector.
+	__m128 row_0 = _mm_load_ps(&A[0]);
+	__m128 row_1 = _mm_load_ps(&A[4]);
+	__m128 row_2 = _mm_load_ps(&A[8]);
+	__m128 row_3 = _mm_load_ps(&A[12]);
+
+	__m128 row01_helper = _mm_unpacklo_ps(row_0, row_1);
+	__m128 row23_helper = _mm_unpacklo_ps(row_2, row_3);
+
+	__m128 col_0 = _mm_shuffle_ps(row01_helper, row23_helper, 0b01000100);
+	__m128 col_1 = _mm_shuffle_ps(row01_helper, row23_helper, 0b11101110);
+
+	row01_helper = _mm_unpackhi_ps(row_0, row_1);
+	row23_helper = _mm_unpackhi_ps(row_2, row_3);
+
+	__m128 col_2 = _mm_shuffle_ps(row01_helper, row23_helper, 0b01000100);
+	__m128 col_3 = _mm_shuffle_ps(row01_helper, row23_helper, 0b11101110);
+
+	for (int i = 0; i < num_vectors; i++) {
+		const float* x = (const float*)&vectors[i];
+		__m128 out_vec = _mm_mul_ps(_mm_broadcast_ss(&x[0]), col_0);
+		out_vec = _mm_fmadd_ps(_mm_broadcast_ss(&x[1]), col_1, out_vec);
+		out_vec = _mm_fmadd_ps(_mm_broadcast_ss(&x[2]), col_2, out_vec);
+		out_vec = _mm_fmadd_ps(_mm_broadcast_ss(&x[3]), col_3, out_vec);
+		_mm_store_ps((float*)&out[i], out_vec);
+	}
+}
+
+void multiply_batch(Vector4* out, const Matrix44& A, const Vector4* vectors, int num_vectors) {
+	TELEMETRY_SCOPE(Kernel::MultiplyBatch44, num_vectors);
+	multiply_batch_44(out, A.m, vectors, num_vectors);
+}
+
+void multiply_batch(Vector4* out, Matrix44View<const float> A, const Vector4* vectors, int num_vectors) {
+	TELEMETRY_SCOPE(Kernel::MultiplyBatch44, num_vectors);
+	multiply_batch_44(out, A.m, vectors, num_vectors);
+}
+
+void convert(Matrix44ColumnMajor& out, const Matrix44& A) {
+	transpose_44(out.m, A.m);
+}
+
+void convert(Matrix44& out, const Matrix44ColumnMajor& A) {
+	transpose_44(out.m, A.m);
+}
+
+// The storage of a column-major matrix is the storage of its transpose in row-major order, so the
+// kernels below run the row-major implementations on it, using (A^T)^T = A, (A^T)^-1 = (A^-1)^T
+// and (AB)^T = B^T A^T.
+
+void transpose(Matrix44ColumnMajor& out, const Matrix44ColumnMajor& A) {
+	transpose_44(out.m, A.m);
+}
+
+void transpose(Matrix44ColumnMajorView<float> out, Matrix44ColumnMajorView<const float> A) {
+	transpose_44(out.m, A.m);
+}
+
+void inverse(Matrix44ColumnMajor& out, const Matrix44ColumnMajor& A, Precision precision) {
+	inverse_44(out.m, A.m, precision);
+}
+
+void inverse(Matrix44ColumnMajorView<float> out, Matrix44ColumnMajorView<const float> A, Precision precision) {
+	inverse_44(out.m, A.m, precision);
+}
+
+void multiply(Matrix44ColumnMajor& out, const Matrix44ColumnMajor& A, const Matrix44ColumnMajor& B) {
+	multiply_44(out.m, B.m, A.m);
+}
+
+void multiply(Matrix44ColumnMajorView<float> out, Matrix44ColumnMajorView<const float> A, Matrix44ColumnMajorView<const float> B) {
+	multiply_44(out.m, B.m, A.m);
+}
+
+inline void multiply_vector_column_major(Vector4& out, const float* A, const Vector4& x) {
+	// The columns are loaded as they are stored:
+	// out = x0*col_0 + x1*col_1 + x2*col_2 + x3*col_3
+	__m128 out_vec = _mm_mul_ps(_mm_broadcast_ss(&x.x), _mm_load_ps(&A[0]));
+	out_vec = _mm_fmadd_ps(_mm_broadcast_ss(&x.y), _mm_load_ps(&A[4]), out_vec);
+	out_vec = _mm_fmadd_ps(_mm_broadcast_ss(&x.z), _mm_load_ps(&A[8]), out_vec);
+	out_vec = _mm_fmadd_ps(_mm_broadcast_ss(&x.w), _mm_load_ps(&A[12]), out_vec);
+
+	_mm_store_ps((float*)&out, out_vec);
+}
+
+void multiply(Vector4& out, const Matrix44ColumnMajor& A, const Vector4& x) {
+	multiply_vector_column_major(out, A.m, x);
+}
+
+void multiply(Vector4& out, Matrix44ColumnMajorView<const float> A, const Vector4& x) {
+	multiply_vector_column_major(out, A.m, x);
+}
+
+inline void multiply_batch_column_major(Vector4* out, const float* A, const Vector4* vectors, int num_vectors) {
+	__m128 col_0 = _mm_load_ps(&A[0]);
+	__m128 col_1 = _mm_load_ps(&A[4]);
+	__m128 col_2 = _mm_load_ps(&A[8]);
+	__m128 col_3 = _mm_load_ps(&A[12]);
+
+	for (int i = 0; i < num_vectors; i++) {
+		const float* x = (const float*)&vectors[i];
+		__m128 out_vec = _mm_mul_ps(_mm_broadcast_ss(&x[0]), col_0);
+		out_vec = _mm_fmadd_ps(_mm_broadcast_ss(&x[1]), col_1, out_vec);
+		out_vec = _mm_fmadd_ps(_mm_broadcast_ss(&x[2]), col_2, out_vec);
+		out_vec = _mm_fmadd_ps(_mm_broadcast_ss(&x[3]), col_3, out_vec);
+		_mm_store_ps((float*)&out[i], out_vec);
+	}
+}
+
+void multiply_batch(Vector4* out, const Matrix44ColumnMajor& A, const Vector4* vectors, int num_vectors) {
+	TELEMETRY_SCOPE(Kernel::MultiplyBatchColumnMajor, num_vectors);
+	multiply_batch_column_major(out, A.m, vectors, num_vectors);
+}
+
+void multiply_batch(Vector4* out, Matrix44ColumnMajorView<const float> A, const Vector4* vectors, int num_vectors) {
+	TELEMETRY_SCOPE(Kernel::MultiplyBatchColumnMajor, num_vectors);
+	multiply_batch_column_major(out, A.m, vectors, num_vectors);
+}
+
+void project_batch(Vector4* out, unsigned char* clip_flags, const Matrix44& mvp, const Vector4* vertices, int num_vertices, const Viewport& viewport) {
+	TELEMETRY_SCOPE(Kernel::ProjectBatch, num_vertices);
+	__m128 row_0 = _mm_load_ps(&mvp.m[0]);
+	__m128 row_1 = _mm_load_ps(&mvp.m[4]);
+	__m128 row_2 = _mm_load_ps(&mvp.m[8]);
+	__m128 row_3 = _mm_load_ps(&mvp.m[12]);
+
+	__m128 row01_helper = _mm_unpacklo_ps(row_0, row_1);
+	__m128 row23_helper = _mm_unpacklo_ps(row_2, row_3);
+
+	__m128 col_0 = _mm_shuffle_ps(row01_helper, row23_helper, 0b01000100);
+	__m128 col_1 = _mm_shuffle_ps(row01_helper, row23_helper, 0b11101110);
+
+	row01_helper = _mm_unpackhi_ps(row_0, row_1);
+	row23_helper = _mm_unpackhi_ps(row_2, row_3);
+
+	__m128 col_2 = _mm_shuffle_ps(row01_helper, row23_helper, 0b01000100);
+	__m128 col_3 = _mm_shuffle_ps(row01_helper, row23_helper, 0b11101110);
+
+	// screen = ndc * scale + offset
+	// scale  = [width/2,     height/2,     (max_depth - min_depth)/2, 0]
+	// offset = [x + width/2, y + height/2, (max_depth + min_depth)/2, 0]
+	__m128 scale = _mm_setr_ps(0.5f * viewport.width, 0.5f * viewport.height, 0.5f * (viewport.max_depth - viewport.min_depth), 0.0f);
+	__m128 offset = _mm_setr_ps(viewport.x + 0.5f * viewport.width, viewport.y + 0.5f * viewport.height, 0.5f * (viewport.max_depth + viewport.min_depth), 0.0f);
+	const __m128 sign_mask = _mm_set1_ps(-0.0f);
+
+	for (int i = 0; i < num_vertices; i++) {
+		const float* v = (const float*)&vertices[i];
+
+		// clip = [cx, cy, cz, cw]
+		__m128 clip = _mm_mul_ps(_mm_broadcast_ss(&v[0]), col_0);
+		clip = _mm_fmadd_ps(_mm_broadcast_ss(&v[1]), col_1, clip);
+		clip = _mm_fmadd_ps(_mm_broadcast_ss(&v[2]), col_2, clip);
+		clip = _mm_fmadd_ps(_mm_broadcast_ss(&v[3]), col_3, clip);
+
+		// w = [cw, cw, cw, cw]
+		__m128 w = _mm_shuffle_ps(clip, clip, 0b11111111);
+
+		// A vertex is outside a plane when a coordinate is below -w or above w. The movemask of
+		// each comparison gives one bit per coordinate, the w bit is masked off.
+		int below = _mm_movemask_ps(_mm_cmplt_ps(clip, _mm_xor_ps(w, sign_mask))) & 0b0111;
+		int above = _mm_movemask_ps(_mm_cmpgt_ps(clip, w)) & 0b0111;
+		// A vertex with w = 0 at the origin of clip space is inside every plane but has no
+		// projection, w <= 0 is flagged on its own so that it is never taken as visible.
+		int behind = _mm_movemask_ps(_mm_cmple_ps(w, _mm_setzero_ps())) & 0b0001;
+		clip_flags[i] = (unsigned char)(below | (above << 3) | (behind << 6));
+
+		// 1/w from the approximate reciprocal refined with one Newton-Raphson step
+		__m128 reciprocal_w = reciprocal(w, Precision::Refined);
+
+		// screen = [sx, sy, depth, 0], then 1/w is blended into the last lane
+		__m128 screen = _mm_fmadd_ps(_mm_mul_ps(clip, reciprocal_w), scale, offset);
+		_mm_store_ps((float*)&out[i], _mm_blend_ps(screen, reciprocal_w, 0b1000));
+	}
+}
+
 inline __m128 adjugate_times_matrix(__m128 vec1, __m128 vec2) {
 	//  AB = A# * B
 	// If A = a0 a1, then:  A# = a3 -a1, and if B = b0 b1, then: A# * B = a3 -a1  *  b0 b1  =  a3*b0 - a1*b2  a3*b1 - a1*b3
@@ -432,6 +706,7 @@ float dot(const Vector4& A, const Vector4& B) {
 }
 
 void dot_batch(float* out, const Vector4& A, Vector4* vectors, int num_vectors) {
+	TELEMETRY_SCOPE(Kernel::DotBatch4, num_vectors);
 	// first batch
 	// __m128 can hold 1 vector
 
@@ -462,4 +737,293 @@ void dot_batch(float* out, const Vector4& A, Vector4* vectors, int num_vectors)
 
 		out[i] = _mm_cvtss_f32(sums);
 	}
+}
+
+inline __m128 normalize_vector(__m128 vec, Precision precision) {
+	// squares = [x*x, y*y, z*z, w*w], summed into every lane with two horizontal adds
+	__m128 length_squared = _mm_mul_ps(vec, vec);
+	length_squared = _mm_hadd_ps(length_squared, length_squared);
+	length_squared = _mm_hadd_ps(length_squared, length_squared);
+
+	// Zero length vectors are left as zero rather than becoming NaN
+	__m128 non_zero = _mm_cmpneq_ps(length_squared, _mm_setzero_ps());
+	if (precision == Precision::Exact) {
+		return _mm_and_ps(_mm_div_ps(vec, _mm_sqrt_ps(length_squared)), non_zero);
+	}
+	return _mm_and_ps(_mm_mul_ps(vec, reciprocal_sqrt(length_squared, precision)), non_zero);
+}
+
+void normalize(Vector4& out, const Vector4& A, Precision precision) {
+	_mm_store_ps((float*)&out, normalize_vector(_mm_load_ps((const float*)&A), precision));
+}
+
+template <Precision precision>
+void normalize_batch(Vector4* out, const Vector4* vectors, int num_vectors) {
+	// Four vectors at a time: the squared components are transposed so that the four squared
+	// lengths are summed vertically into one register, which needs fewer shuffles than two
+	// horizontal adds per vector and a single (r)sqrt for all four.
+	int i = 0;
+	for (; i + 4 <= num_vectors; i += 4) {
+		__m128 vec_0 = _mm_load_ps((const float*)&vectors[i]);
+		__m128 vec_1 = _mm_load_ps((const float*)&vectors[i + 1]);
+		__m128 vec_2 = _mm_load_ps((const float*)&vectors[i + 2]);
+		__m128 vec_3 = _mm_load_ps((const float*)&vectors[i + 3]);
+
+		__m128 sq_0 = _mm_mul_ps(vec_0, vec_0);
+		__m128 sq_1 = _mm_mul_ps(vec_1, vec_1);
+		__m128 sq_2 = _mm_mul_ps(vec_2, vec_2);
+		__m128 sq_3 = _mm_mul_ps(vec_3, vec_3);
+		_MM_TRANSPOSE4_PS(sq_0, sq_1, sq_2, sq_3);
+
+		// length_squared = [|v0|^2, |v1|^2, |v2|^2, |v3|^2]
+		__m128 length_squared = _mm_add_ps(_mm_add_ps(sq_0, sq_1), _mm_add_ps(sq_2, sq_3));
+		__m128 non_zero = _mm_cmpneq_ps(length_squared, _mm_setzero_ps());
+
+		if (precision == Precision::Exact) {
+			__m128 length = _mm_sqrt_ps(length_squared);
+			_mm_store_ps((float*)&out[i], _mm_and_ps(_mm_div_ps(vec_0, _mm_shuffle_ps(length, length, 0b00000000)), _mm_shuffle_ps(non_zero, non_zero, 0b00000000)));
+			_mm_store_ps((float*)&out[i + 1], _mm_and_ps(_mm_div_ps(vec_1, _mm_shuffle_ps(length, length, 0b01010101)), _mm_shuffle_ps(non_zero, non_zero, 0b01010101)));
+			_mm_store_ps((float*)&out[i + 2], _mm_and_ps(_mm_div_ps(vec_2, _mm_shuffle_ps(length, length, 0b10101010)), _mm_shuffle_ps(non_zero, non_zero, 0b10101010)));
+			_mm_store_ps((float*)&out[i + 3], _mm_and_ps(_mm_div_ps(vec_3, _mm_shuffle_ps(length, length, 0b11111111)), _mm_shuffle_ps(non_zero, non_zero, 0b11111111)));
+		}
+		else {
+			// rsqrt(0) is infinity, masking it to zero leaves zero length vectors as zero
+			__m128 scale = _mm_and_ps(reciprocal_sqrt(length_squared, precision), non_zero);
+			_mm_store_ps((float*)&out[i], _mm_mul_ps(vec_0, _mm_shuffle_ps(scale, scale, 0b00000000)));
+			_mm_store_ps((float*)&out[i + 1], _mm_mul_ps(vec_1, _mm_shuffle_ps(scale, scale, 0b01010101)));
+			_mm_store_ps((float*)&out[i + 2], _mm_mul_ps(vec_2, _mm_shuffle_ps(scale, scale, 0b10101010)));
+			_mm_store_ps((float*)&out[i + 3], _mm_mul_ps(vec_3, _mm_shuffle_ps(scale, scale, 0b11111111)));
+		}
+	}
+
+	for (; i < num_vectors; i++) {
+		_mm_store_ps((float*)&out[i], normalize_vector(_mm_load_ps((const float*)&vectors[i]), precision));
+	}
+}
+
+void normalize_batch(Vector4* out, const Vector4* vectors, int num_vectors, Precision precision) {
+	TELEMETRY_SCOPE(Kernel::NormalizeBatch4, num_vectors);
+	// Dispatch once so that the precision branch is not taken for every vector
+	switch (precision) {
+	case Precision::Exact:
+		normalize_batch<Precision::Exact>(out, vectors, num_vectors);
+		break;
+	case Precision::Refined:
+		normalize_batch<Precision::Refined>(out, vectors, num_vectors);
+		break;
+	case Precision::Approximate:
+		normalize_batch<Precision::Approximate>(out, vectors, num_vectors);
+		break;
+	}
+}
+
+float dot(const Vector3& A, const Vector3& B) {
+	return A.x * B.x + A.y * B.y + A.z * B.z;
+}
+
+void cross(Vector3& out, const Vector3& A, const Vector3& B) {
+	float x = A.y * B.z - A.z * B.y;
+	float y = A.z * B.x - A.x * B.z;
+	float z = A.x * B.y - A.y * B.x;
+	out.x = x;
+	out.y = y;
+	out.z = z;
+}
+
+float length(const Vector3& A) {
+	return std::sqrt(dot(A, A));
+}
+
+void normalize(Vector3& out, const Vector3& A, Precision precision) {
+	float length_squared = dot(A, A);
+	if (length_squared == 0.0f) {
+		out = Vector3();
+		return;
+	}
+
+	if (precision == Precision::Exact) {
+		// Divided rather than multiplied by 1/length, so that each component is rounded once
+		float length = std::sqrt(length_squared);
+		out.x = A.x / length;
+		out.y = A.y / length;
+		out.z = A.z / length;
+		return;
+	}
+
+	float scale = _mm_cvtss_f32(reciprocal_sqrt(_mm_set1_ps(length_squared), precision));
+	out.x = A.x * scale;
+	out.y = A.y * scale;
+	out.z = A.z * scale;
+}
+
+void lerp(Vector3& out, const Vector3& A, const Vector3& B, float t) {
+	out.x = A.x + t * (B.x - A.x);
+	out.y = A.y + t * (B.y - A.y);
+	out.z = A.z + t * (B.z - A.z);
+}
+
+void multiply(Vector3& out, const Matrix33& A, const Vector3& x) {
+	float x0 = A.m[0] * x.x + A.m[1] * x.y + A.m[2] * x.z;
+	float x1 = A.m[3] * x.x + A.m[4] * x.y + A.m[5] * x.z;
+	float x2 = A.m[6] * x.x + A.m[7] * x.y + A.m[8] * x.z;
+	out.x = x0;
+	out.y = x1;
+	out.z = x2;
+}
+
+void cross_batch(const Vector3SoA& out, const Vector3SoAConst& A, const Vector3SoAConst& B, int num_vectors) {
+	TELEMETRY_SCOPE(Kernel::CrossBatch3, num_vectors);
+	int i = 0;
+	for (; i + 8 <= num_vectors; i += 8) {
+		__m256 ax = _mm256_loadu_ps(&A.x[i]);
+		__m256 ay = _mm256_loadu_ps(&A.y[i]);
+		__m256 az = _mm256_loadu_ps(&A.z[i]);
+		__m256 bx = _mm256_loadu_ps(&B.x[i]);
+		__m256 by = _mm256_loadu_ps(&B.y[i]);
+		__m256 bz = _mm256_loadu_ps(&B.z[i]);
+
+		// x = ay*bz - az*by, y = az*bx - ax*bz, z = ax*by - ay*bx
+		_mm256_storeu_ps(&out.x[i], _mm256_fmsub_ps(ay, bz, _mm256_mul_ps(az, by)));
+		_mm256_storeu_ps(&out.y[i], _mm256_fmsub_ps(az, bx, _mm256_mul_ps(ax, bz)));
+		_mm256_storeu_ps(&out.z[i], _mm256_fmsub_ps(ax, by, _mm256_mul_ps(ay, bx)));
+	}
+
+	for (; i < num_vectors; i++) {
+		float x = A.y[i] * B.z[i] - A.z[i] * B.y[i];
+		float y = A.z[i] * B.x[i] - A.x[i] * B.z[i];
+		float z = A.x[i] * B.y[i] - A.y[i] * B.x[i];
+		out.x[i] = x;
+		out.y[i] = y;
+		out.z[i] = z;
+	}
+}
+
+void length_batch(float* out, const Vector3SoAConst& vectors, int num_vectors) {
+	TELEMETRY_SCOPE(Kernel::LengthBatch3, num_vectors);
+	int i = 0;
+	for (; i + 8 <= num_vectors; i += 8) {
+		__m256 x = _mm256_loadu_ps(&vectors.x[i]);
+		__m256 y = _mm256_loadu_ps(&vectors.y[i]);
+		__m256 z = _mm256_loadu_ps(&vectors.z[i]);
+
+		__m256 length_squared = _mm256_mul_ps(x, x);
+		length_squared = _mm256_fmadd_ps(y, y, length_squared);
+		length_squared = _mm256_fmadd_ps(z, z, length_squared);
+		_mm256_storeu_ps(&out[i], _mm256_sqrt_ps(length_squared));
+	}
+
+	for (; i < num_vectors; i++) {
+		out[i] = std::sqrt(vectors.x[i] * vectors.x[i] + vectors.y[i] * vectors.y[i] + vectors.z[i] * vectors.z[i]);
+	}
+}
+
+template <Precision precision>
+void normalize_batch(const Vector3SoA& out, const Vector3SoAConst& vectors, int num_vectors) {
+	int i = 0;
+	for (; i + 8 <= num_vectors; i += 8) {
+		__m256 x = _mm256_loadu_ps(&vectors.x[i]);
+		__m256 y = _mm256_loadu_ps(&vectors.y[i]);
+		__m256 z = _mm256_loadu_ps(&vectors.z[i]);
+
+		__m256 length_squared = _mm256_mul_ps(x, x);
+		length_squared = _mm256_fmadd_ps(y, y, length_squared);
+		length_squared = _mm256_fmadd_ps(z, z, length_squared);
+
+		// Zero length vectors are left as zero rather than becoming NaN
+		__m256 non_zero = _mm256_cmp_ps(length_squared, _mm256_setzero_ps(), _CMP_NEQ_OQ);
+		if constexpr (precision == Precision::Exact) {
+			__m256 length = _mm256_sqrt_ps(length_squared);
+			_mm256_storeu_ps(&out.x[i], _mm256_and_ps(_mm256_div_ps(x, length), non_zero));
+			_mm256_storeu_ps(&out.y[i], _mm256_and_ps(_mm256_div_ps(y, length), non_zero));
+			_mm256_storeu_ps(&out.z[i], _mm256_and_ps(_mm256_div_ps(z, length), non_zero));
+		}
+		else {
+			__m256 scale = _mm256_and_ps(reciprocal_sqrt(length_squared, precision), non_zero);
+			_mm256_storeu_ps(&out.x[i], _mm256_mul_ps(x, scale));
+			_mm256_storeu_ps(&out.y[i], _mm256_mul_ps(y, scale));
+			_mm256_storeu_ps(&out.z[i], _mm256_mul_ps(z, scale));
+		}
+	}
+
+	for (; i < num_vectors; i++) {
+		Vector3 normalized;
+		normalize(normalized, Vector3(vectors.x[i], vectors.y[i], vectors.z[i]), precision);
+		out.x[i] = normalized.x;
+		out.y[i] = normalized.y;
+		out.z[i] = normalized.z;
+	}
+}
+
+void normalize_batch(const Vector3SoA& out, const Vector3SoAConst& vectors, int num_vectors, Precision precision) {
+	TELEMETRY_SCOPE(Kernel::NormalizeBatch3, num_vectors);
+	switch (precision) {
+	case Precision::Exact:
+		normalize_batch<Precision::Exact>(out, vectors, num_vectors);
+		break;
+	case Precision::Refined:
+		normalize_batch<Precision::Refined>(out, vectors, num_vectors);
+		break;
+	case Precision::Approximate:
+		normalize_batch<Precision::Approximate>(out, vectors, num_vectors);
+		break;
+	}
+}
+
+void lerp_batch(const Vector3SoA& out, const Vector3SoAConst& A, const Vector3SoAConst& B, float t, int num_vectors) {
+	TELEMETRY_SCOPE(Kernel::LerpBatch3, num_vectors);
+	// out = A + t * (B - A)
+	__m256 vec_t = _mm256_broadcast_ss(&t);
+
+	int i = 0;
+	for (; i + 8 <= num_vectors; i += 8) {
+		__m256 ax = _mm256_loadu_ps(&A.x[i]);
+		__m256 ay = _mm256_loadu_ps(&A.y[i]);
+		__m256 az = _mm256_loadu_ps(&A.z[i]);
+		_mm256_storeu_ps(&out.x[i], _mm256_fmadd_ps(vec_t, _mm256_sub_ps(_mm256_loadu_ps(&B.x[i]), ax), ax));
+		_mm256_storeu_ps(&out.y[i], _mm256_fmadd_ps(vec_t, _mm256_sub_ps(_mm256_loadu_ps(&B.y[i]), ay), ay));
+		_mm256_storeu_ps(&out.z[i], _mm256_fmadd_ps(vec_t, _mm256_sub_ps(_mm256_loadu_ps(&B.z[i]), az), az));
+	}
+
+	for (; i < num_vectors; i++) {
+		out.x[i] = A.x[i] + t * (B.x[i] - A.x[i]);
+		out.y[i] = A.y[i] + t * (B.y[i] - A.y[i]);
+		out.z[i] = A.z[i] + t * (B.z[i] - A.z[i]);
+	}
+}
+
+void multiply_batch(const Vector3SoA& out, const Matrix33& A, const Vector3SoAConst& vectors, int num_vectors) {
+	TELEMETRY_SCOPE(Kernel::MultiplyBatch33, num_vectors);
+	// In structure of arrays form every matrix element is broadcast once and each output
+	// component is three multiply-adds across eight vectors, no shuffles are needed:
+	// out.x = a0*x + a1*y + a2*z
+	// out.y = a3*x + a4*y + a5*z
+	// out.z = a6*x + a7*y + a8*z
+	__m256 a0 = _mm256_broadcast_ss(&A.m[0]);
+	__m256 a1 = _mm256_broadcast_ss(&A.m[1]);
+	__m256 a2 = _mm256_broadcast_ss(&A.m[2]);
+	__m256 a3 = _mm256_broadcast_ss(&A.m[3]);
+	__m256 a4 = _mm256_broadcast_ss(&A.m[4]);
+	__m256 a5 = _mm256_broadcast_ss(&A.m[5]);
+	__m256 a6 = _mm256_broadcast_ss(&A.m[6]);
+	__m256 a7 = _mm256_broadcast_ss(&A.m[7]);
+	__m256 a8 = _mm256_broadcast_ss(&A.m[8]);
+
+	int i = 0;
+	for (; i + 8 <= num_vectors; i += 8) {
+		__m256 x = _mm256_loadu_ps(&vectors.x[i]);
+		__m256 y = _mm256_loadu_ps(&vectors.y[i]);
+		__m256 z = _mm256_loadu_ps(&vectors.z[i]);
+
+		_mm256_storeu_ps(&out.x[i], _mm256_fmadd_ps(a2, z, _mm256_fmadd_ps(a1, y, _mm256_mul_ps(a0, x))));
+		_mm256_storeu_ps(&out.y[i], _mm256_fmadd_ps(a5, z, _mm256_fmadd_ps(a4, y, _mm256_mul_ps(a3, x))));
+		_mm256_storeu_ps(&out.z[i], _mm256_fmadd_ps(a8, z, _mm256_fmadd_ps(a7, y, _mm256_mul_ps(a6, x))));
+	}
+
+	for (; i < num_vectors; i++) {
+		Vector3 transformed;
+		multiply(transformed, A, Vector3(vectors.x[i], vectors.y[i], vectors.z[i]));
+		out.x[i] = transformed.x;
+		out.y[i] = transformed.y;
+		out.z[i] = transformed.z;
+	}
 }
\ No newline at end of file
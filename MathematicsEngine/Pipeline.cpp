@@ -0,0 +1,110 @@
+#include <algorithm>
+#include <thread>
+
+#include "MathematicsEngine.h"
+#include "Telemetry.h"
+
+const int Pipeline::chunk_size;
+const int Pipeline::prefetch_step;
+
+int parallel_for_range(int count, int num_threads) {
+	if (num_threads <= 1 || count <= 1) {
+		return std::max(count, 1);
+	}
+	num_threads = std::min(num_threads, count);
+	return (count + num_threads - 1) / num_threads;
+}
+
+void parallel_for(int count, int num_threads, const std::function<void(int begin, int end)>& body) {
+	if (num_threads <= 1 || count <= 1) {
+		body(0, count);
+		return;
+	}
+
+	int range = parallel_for_range(count, num_threads);
+
+	// The calling thread takes the first range itself, the rest are handed to workers
+	std::vector<std::thread> workers;
+	for (int begin = range; begin < count; begin += range) {
+		int end = std::min(begin + range, count);
+		workers.push_back(std::thread(body, begin, end));
+	}
+	body(0, std::min(range, count));
+
+	for (std::thread& worker : workers) {
+		worker.join();
+	}
+}
+
+Pipeline& Pipeline::transform(const Matrix44& A) {
+	const Matrix44* matrix = &A;
+	stages.push_back([matrix](Vector4* vectors, int begin, int end) {
+		multiply_batch(&vectors[begin], *matrix, &vectors[begin], end - begin);
+	});
+	return *this;
+}
+
+Pipeline& Pipeline::normalize(Precision precision) {
+	stages.push_back([precision](Vector4* vectors, int begin, int end) {
+		normalize_batch(&vectors[begin], &vectors[begin], end - begin, precision);
+	});
+	return *this;
+}
+
+Pipeline& Pipeline::dot(float* out, const Vector4& A) {
+	const Vector4* vector = &A;
+	stages.push_back([out, vector](Vector4* vectors, int begin, int end) {
+		dot_batch(&out[begin], *vector, &vectors[begin], end - begin);
+	});
+	return *this;
+}
+
+Pipeline& Pipeline::prefetch(int distance) {
+	prefetch_distance = distance;
+	return *this;
+}
+
+Pipeline& Pipeline::stage(const PipelineStage& stage) {
+	stages.push_back(stage);
+	return *this;
+}
+
+void Pipeline::run(Vector4* vectors, int num_vectors, int num_threads) const {
+	TELEMETRY_SCOPE(Kernel::PipelineRun, num_vectors);
+	int num_chunks = (num_vectors + chunk_size - 1) / chunk_size;
+
+	parallel_for(num_chunks, num_threads, [this, vectors, num_vectors](int first_chunk, int last_chunk) {
+		TELEMETRY_NESTED();
+		int end = std::min(last_chunk * chunk_size, num_vectors);
+
+		for (int begin = first_chunk * chunk_size; begin < end; begin += chunk_size) {
+			int chunk_end = std::min(begin + chunk_size, end);
+
+			// The first stage is what brings the chunk in from memory. It is run a few cache lines
+			// at a time, and before each step the same number of lines prefetch_distance vectors
+			// ahead is requested, so the loads are spread over the work instead of issued in one
+			// burst. The later stages find the chunk in L2.
+			if (!stages.empty()) {
+				if (prefetch_distance > 0) {
+					for (int i = begin; i < chunk_end; i += prefetch_step) {
+						int step_end = std::min(i + prefetch_step, chunk_end);
+						int ahead = std::min(i + prefetch_distance, num_vectors);
+						int ahead_end = std::min(ahead + prefetch_step, num_vectors);
+						// A 64 byte cache line holds four Vector4
+						for (int j = ahead; j < ahead_end; j += 4) {
+							_mm_prefetch((const char*)&vectors[j], _MM_HINT_T0);
+						}
+						stages[0](vectors, i, step_end);
+					}
+				}
+				else {
+					stages[0](vectors, begin, chunk_end);
+				}
+			}
+
+			for (size_t i = 1; i < stages.size(); i++) {
+				stages[i](vectors, begin, chunk_end);
+			}
+		}
+	});
+}
\ No newline at end of file
@@ -0,0 +1,300 @@
+#include <algorithm>
+
+#include "MathematicsEngine.h"
+#include "Telemetry.h"
+
+// Each accumulator sums a stream of values made of a fixed number of channels. A channel is either
+// four floats (__m128) or four doubles (__m256d), the accumulators only use these helpers on them.
+
+inline void set_zero(__m128& x) { x = _mm_setzero_ps(); }
+inline void set_zero(__m256d& x) { x = _mm256_setzero_pd(); }
+inline __m128 lanes_add(__m128 a, __m128 b) { return _mm_add_ps(a, b); }
+inline __m256d lanes_add(__m256d a, __m256d b) { return _mm256_add_pd(a, b); }
+inline __m128 lanes_sub(__m128 a, __m128 b) { return _mm_sub_ps(a, b); }
+inline __m256d lanes_sub(__m256d a, __m256d b) { return _mm256_sub_pd(a, b); }
+
+template <class Lanes, int channels>
+struct NaiveSum {
+	Lanes total[channels];
+
+	NaiveSum() {
+		for (int c = 0; c < channels; c++) {
+			set_zero(total[c]);
+		}
+	}
+
+	void add(const Lanes* values) {
+		for (int c = 0; c < channels; c++) {
+			total[c] = lanes_add(total[c], values[c]);
+		}
+	}
+
+	void result(Lanes* out) const {
+		for (int c = 0; c < channels; c++) {
+			out[c] = total[c];
+		}
+	}
+};
+
+template <class Lanes, int channels>
+struct KahanSum {
+	Lanes total[channels];
+	Lanes compensation[channels];
+
+	KahanSum() {
+		for (int c = 0; c < channels; c++) {
+			set_zero(total[c]);
+			set_zero(compensation[c]);
+		}
+	}
+
+	void add(const Lanes* values) {
+		// The low order bits lost when adding y to the total are recovered in the compensation
+		// and subtracted from the next value.
+		for (int c = 0; c < channels; c++) {
+			Lanes y = lanes_sub(values[c], compensation[c]);
+			Lanes t = lanes_add(total[c], y);
+			compensation[c] = lanes_sub(lanes_sub(t, total[c]), y);
+			total[c] = t;
+		}
+	}
+
+	void result(Lanes* out) const {
+		for (int c = 0; c < channels; c++) {
+			out[c] = lanes_sub(total[c], compensation[c]);
+		}
+	}
+};
+
+template <class Lanes, int channels>
+struct PairwiseSum {
+	// Values are summed naively into blocks and the block sums are merged like a binary
+	// counter: levels[l] holds the sum of 2^l blocks and two sums are only added when they
+	// cover the same number of blocks. This keeps the error growth logarithmic in a single pass.
+	static const int block_size = 256;
+
+	Lanes block[channels];
+	int block_count;
+	Lanes levels[32][channels];
+	unsigned int num_blocks;
+
+	PairwiseSum() : block_count(0), num_blocks(0) {
+		for (int c = 0; c < channels; c++) {
+			set_zero(block[c]);
+		}
+	}
+
+	void add(const Lanes* values) {
+		for (int c = 0; c < channels; c++) {
+			block[c] = lanes_add(block[c], values[c]);
+		}
+		if (++block_count == block_size) {
+			int level = 0;
+			while (num_blocks & (1u << level)) {
+				for (int c = 0; c < channels; c++) {
+					block[c] = lanes_add(levels[level][c], block[c]);
+				}
+				level++;
+			}
+			for (int c = 0; c < channels; c++) {
+				levels[level][c] = block[c];
+				set_zero(block[c]);
+			}
+			num_blocks++;
+			block_count = 0;
+		}
+	}
+
+	void result(Lanes* out) const {
+		for (int c = 0; c < channels; c++) {
+			out[c] = block[c];
+		}
+		for (int level = 0; level < 32; level++) {
+			if (num_blocks & (1u << level)) {
+				for (int c = 0; c < channels; c++) {
+					out[c] = lanes_add(out[c], levels[level][c]);
+				}
+			}
+		}
+	}
+};
+
+// Sums terms(point) over points[begin, end). Four independent accumulators take every fourth
+// point so that consecutive additions do not wait on each other.
+template <template <class, int> class Accumulator, class Lanes, int channels, class Terms>
+void accumulate(Lanes* out, const Vector4* points, int begin, int end, Terms terms) {
+	Accumulator<Lanes, channels> accumulators[4];
+	Lanes values[channels];
+
+	int i = begin;
+	for (; i + 4 <= end; i += 4) {
+		for (int k = 0; k < 4; k++) {
+			terms(_mm_load_ps((const float*)&points[i + k]), values);
+			accumulators[k].add(values);
+		}
+	}
+	for (; i < end; i++) {
+		terms(_mm_load_ps((const float*)&points[i]), values);
+		accumulators[0].add(values);
+	}
+
+	Lanes partial[4][channels];
+	for (int k = 0; k < 4; k++) {
+		accumulators[k].result(partial[k]);
+	}
+	for (int c = 0; c < channels; c++) {
+		out[c] = lanes_add(lanes_add(partial[0][c], partial[1][c]), lanes_add(partial[2][c], partial[3][c]));
+	}
+}
+
+template <class Lanes, int channels>
+struct Partial {
+	Lanes value[channels];
+};
+
+// Runs accumulate over the ranges of parallel_for and adds the partial sums in order of their
+// ranges, so the result does not depend on which thread finishes first. The ranges are fixed by
+// parallel_for_range, so every range writes its own slot and no lock is needed.
+template <class Lanes, int channels, class Terms>
+void reduce(Lanes* out, const Vector4* points, int num_points, Summation summation, int num_threads, Terms terms) {
+	int range = parallel_for_range(num_points, num_threads);
+	std::vector<Partial<Lanes, channels>> partials(std::max(1, (num_points + range - 1) / range));
+
+	parallel_for(num_points, num_threads, [&](int begin, int end) {
+		Partial<Lanes, channels>& partial = partials[begin / range];
+		switch (summation) {
+		case Summation::Naive:
+			accumulate<NaiveSum, Lanes, channels>(partial.value, points, begin, end, terms);
+			break;
+		case Summation::Kahan:
+			accumulate<KahanSum, Lanes, channels>(partial.value, points, begin, end, terms);
+			break;
+		case Summation::Pairwise:
+			accumulate<PairwiseSum, Lanes, channels>(partial.value, points, begin, end, terms);
+			break;
+		}
+	});
+
+	for (int c = 0; c < channels; c++) {
+		set_zero(out[c]);
+		for (const Partial<Lanes, channels>& partial : partials) {
+			out[c] = lanes_add(out[c], partial.value[c]);
+		}
+	}
+}
+
+void bounds(Vector4& min, Vector4& max, const Vector4* points, int num_points, int num_threads) {
+	TELEMETRY_SCOPE(Kernel::Bounds, num_points);
+	if (num_points <= 0) {
+		min = Vector4();
+		max = Vector4();
+		return;
+	}
+
+	int range = parallel_for_range(num_points, num_threads);
+	int num_ranges = (num_points + range - 1) / range;
+	std::vector<__m128> range_mins(num_ranges), range_maxs(num_ranges);
+
+	parallel_for(num_points, num_threads, [&](int begin, int end) {
+		// Four independent minimum and maximum accumulators, as in accumulate
+		__m128 first = _mm_load_ps((const float*)&points[begin]);
+		__m128 mins[4] = { first, first, first, first };
+		__m128 maxs[4] = { first, first, first, first };
+
+		int i = begin;
+		for (; i + 4 <= end; i += 4) {
+			for (int k = 0; k < 4; k++) {
+				__m128 point = _mm_load_ps((const float*)&points[i + k]);
+				mins[k] = _mm_min_ps(mins[k], point);
+				maxs[k] = _mm_max_ps(maxs[k], point);
+			}
+		}
+		for (; i < end; i++) {
+			__m128 point = _mm_load_ps((const float*)&points[i]);
+			mins[0] = _mm_min_ps(mins[0], point);
+			maxs[0] = _mm_max_ps(maxs[0], point);
+		}
+
+		range_mins[begin / range] = _mm_min_ps(_mm_min_ps(mins[0], mins[1]), _mm_min_ps(mins[2], mins[3]));
+		range_maxs[begin / range] = _mm_max_ps(_mm_max_ps(maxs[0], maxs[1]), _mm_max_ps(maxs[2], maxs[3]));
+	});
+
+	__m128 min_vec = range_mins[0];
+	__m128 max_vec = range_maxs[0];
+	for (int r = 1; r < num_ranges; r++) {
+		min_vec = _mm_min_ps(min_vec, range_mins[r]);
+		max_vec = _mm_max_ps(max_vec, range_maxs[r]);
+	}
+
+	_mm_store_ps((float*)&min, min_vec);
+	_mm_store_ps((float*)&max, max_vec);
+}
+
+void sum(Vector4& out, const Vector4* points, int num_points, Summation summation, int num_threads) {
+	TELEMETRY_SCOPE(Kernel::Sum, num_points);
+	__m128 total;
+	reduce<__m128, 1>(&total, points, num_points, summation, num_threads, [](__m128 point, __m128* values) {
+		values[0] = point;
+	});
+	_mm_store_ps((float*)&out, total);
+}
+
+void mean(Vector4& out, const Vector4* points, int num_points, Summation summation, int num_threads) {
+	TELEMETRY_SCOPE(Kernel::Mean, num_points);
+	if (num_points <= 0) {
+		out = Vector4();
+		return;
+	}
+
+	sum(out, points, num_points, summation, num_threads);
+	float scale = 1.0f / num_points;
+	_mm_store_ps((float*)&out, _mm_mul_ps(_mm_load_ps((const float*)&out), _mm_broadcast_ss(&scale)));
+}
+
+void covariance(Matrix33& out, Vector4& mean, const Vector4* points, int num_points, Summation summation, int num_threads) {
+	TELEMETRY_SCOPE(Kernel::Covariance, num_points);
+	out = Matrix33();
+	mean = Vector4();
+	if (num_points <= 0) {
+		return;
+	}
+
+	// The moments are taken about the first point rather than the origin, and are summed in double.
+	// The single pass formula cov = E[d d^T] - E[d] E[d]^T cancels when the mean is far from zero
+	// compared to the spread. The shift keeps E[d] small for clustered points, and double sums keep
+	// the cancellation harmless when the first point is an outlier.
+	__m128 origin = _mm_load_ps((const float*)&points[0]);
+	__m256d origin_d = _mm256_cvtps_pd(origin);
+
+	// moments[0] = sum of d                 = [dx, dy, dz, dw]
+	// moments[1] = sum of d * d             = [dx*dx, dy*dy, dz*dz, dw*dw]
+	// moments[2] = sum of d * [dy dz dx dw] = [dx*dy, dy*dz, dz*dx, dw*dw]
+	__m256d moments[3];
+	reduce<__m256d, 3>(moments, points, num_points, summation, num_threads, [origin_d](__m128 point, __m256d* values) {
+		__m256d d = _mm256_sub_pd(_mm256_cvtps_pd(point), origin_d);
+		values[0] = d;
+		values[1] = _mm256_mul_pd(d, d);
+		values[2] = _mm256_mul_pd(d, _mm256_permute4x64_pd(d, _MM_SHUFFLE(3, 0, 2, 1)));
+	});
+
+	double first[4], second[4], cross[4];
+	alignas(16) float shift[4];
+	_mm256_storeu_pd(first, moments[0]);
+	_mm256_storeu_pd(second, moments[1]);
+	_mm256_storeu_pd(cross, moments[2]);
+	_mm_store_ps(shift, origin);
+
+	double n = num_points;
+	double mx = first[0] / n, my = first[1] / n, mz = first[2] / n;
+	double xx = second[0] / n - mx * mx;
+	double yy = second[1] / n - my * my;
+	double zz = second[2] / n - mz * mz;
+	double xy = cross[0] / n - mx * my;
+	double yz = cross[1] / n - my * mz;
+	double zx = cross[2] / n - mz * mx;
+
+	out = Matrix33((float)xx, (float)xy, (float)zx,
+		(float)xy, (float)yy, (float)yz,
+		(float)zx, (float)yz, (float)zz);
+	mean = Vector4((float)(shift[0] + mx), (float)(shift[1] + my), (float)(shift[2] + mz), (float)(shift[3] + first[3] / n));
+}
\ No newline at end of file
@@ -0,0 +1,66 @@
+#include <cassert>
+
+#include "MathematicsEngine.h"
+#include "Telemetry.h"
+
+void skin_batch(Vector4* out_positions, Vector4* out_normals, const Matrix44* bones, int num_bones,
+	const SkinWeights* weights, const Vector4* positions, const Vector4* normals, int num_vertices, int num_threads) {
+	TELEMETRY_SCOPE(Kernel::SkinBatch, num_vertices);
+	bool skin_normals = normals != nullptr && out_normals != nullptr;
+
+	parallel_for(num_vertices, num_threads, [=](int begin, int end) {
+		for (int i = begin; i < end; i++) {
+			const SkinWeights& influence = weights[i];
+
+			// The rows of the blended matrix are accumulated straight from the bone rows,
+			// rows_01 = [row_0 | row_1], rows_23 = [row_2 | row_3]
+			assert(influence.bone[0] >= 0 && influence.bone[0] < num_bones);
+			__m256 weight = _mm256_broadcast_ss(&influence.weight[0]);
+			const float* bone = bones[influence.bone[0]].m;
+			__m256 rows_01 = _mm256_mul_ps(weight, _mm256_load_ps(&bone[0]));
+			__m256 rows_23 = _mm256_mul_ps(weight, _mm256_load_ps(&bone[8]));
+
+			for (int k = 1; k < 4; k++) {
+				assert(influence.bone[k] >= 0 && influence.bone[k] < num_bones);
+				weight = _mm256_broadcast_ss(&influence.weight[k]);
+				bone = bones[influence.bone[k]].m;
+				rows_01 = _mm256_fmadd_ps(weight, _mm256_load_ps(&bone[0]), rows_01);
+				rows_23 = _mm256_fmadd_ps(weight, _mm256_load_ps(&bone[8]), rows_23);
+			}
+
+			// The blended matrix is transposed into columns once per vertex as in project_batch,
+			// and applied to the position and the normal with broadcasts and multiply-adds.
+			__m128 row_0 = _mm256_castps256_ps128(rows_01);
+			__m128 row_1 = _mm256_extractf128_ps(rows_01, 1);
+			__m128 row_2 = _mm256_castps256_ps128(rows_23);
+			__m128 row_3 = _mm256_extractf128_ps(rows_23, 1);
+
+			__m128 row01_helper = _mm_unpacklo_ps(row_0, row_1);
+			__m128 row23_helper = _mm_unpacklo_ps(row_2, row_3);
+
+			__m128 col_0 = _mm_shuffle_ps(row01_helper, row23_helper, 0b01000100);
+			__m128 col_1 = _mm_shuffle_ps(row01_helper, row23_helper, 0b11101110);
+
+			row01_helper = _mm_unpackhi_ps(row_0, row_1);
+			row23_helper = _mm_unpackhi_ps(row_2, row_3);
+
+			__m128 col_2 = _mm_shuffle_ps(row01_helper, row23_helper, 0b01000100);
+			__m128 col_3 = _mm_shuffle_ps(row01_helper, row23_helper, 0b11101110);
+
+			const float* x = (const float*)&positions[i];
+			__m128 out_vec = _mm_mul_ps(_mm_broadcast_ss(&x[0]), col_0);
+			out_vec = _mm_fmadd_ps(_mm_broadcast_ss(&x[1]), col_1, out_vec);
+			out_vec = _mm_fmadd_ps(_mm_broadcast_ss(&x[2]), col_2, out_vec);
+			out_vec = _mm_fmadd_ps(_mm_broadcast_ss(&x[3]), col_3, out_vec);
+			_mm_store_ps((float*)&out_positions[i], out_vec);
+
+			if (skin_normals) {
+				const float* n = (const float*)&normals[i];
+				out_vec = _mm_mul_ps(_mm_broadcast_ss(&n[0]), col_0);
+				out_vec = _mm_fmadd_ps(_mm_broadcast_ss(&n[1]), col_1, out_vec);
+				out_vec = _mm_fmadd_ps(_mm_broadcast_ss(&n[2]), col_2, out_vec);
+				_mm_store_ps((float*)&out_normals[i], out_vec);
+			}
+		}
+	});
+}
\ No newline at end of file
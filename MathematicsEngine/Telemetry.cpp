@@ -0,0 +1,203 @@
+#include <atomic>
+#include <mutex>
+
+#include "Telemetry.h"
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_ARM64))
+#pragma intrinsic(_BitScanReverse64)
+#elif defined(_MSC_VER)
+#pragma intrinsic(_BitScanReverse)
+#endif
+
+static const char* kernel_names[(int)Kernel::Count] = {
+	"multiply_batch33", "multiply_batch44", "project_batch", "multiply_batch_column_major",
+	"dot_batch4", "normalize_batch4",
+	"cross_batch3", "length_batch3", "normalize_batch3", "lerp_batch3",
+	"skin_batch", "pipeline_run", "bounds", "sum", "mean", "covariance"
+};
+
+// Counters of one kernel on one thread. Only the owning thread writes them, so an update is a
+// relaxed load and store rather than a locked read-modify-write. They are atomic so that
+// snapshots can read them from another thread.
+struct KernelCounters {
+	std::atomic<unsigned long long> calls;
+	std::atomic<unsigned long long> elements;
+	std::atomic<unsigned long long> ticks;
+	std::atomic<unsigned long long> histogram[KernelTelemetry::num_buckets];
+};
+
+struct ThreadTelemetry;
+
+// Every live thread that has recorded telemetry, and the totals of threads that have exited.
+// Guarded by mutex, which is only taken when a thread first records, when it exits and by
+// snapshots.
+struct Registry {
+	std::mutex mutex;
+	std::vector<ThreadTelemetry*> threads;
+	std::vector<KernelTelemetry> retired;
+	std::vector<KernelTelemetry> baseline;
+
+	Registry() : retired((int)Kernel::Count), baseline((int)Kernel::Count) {}
+};
+
+// Constructed on first use, so kernels called during the static initialisation of another
+// translation unit find it ready.
+static Registry& registry() {
+	static Registry instance;
+	return instance;
+}
+
+static void add_counters(KernelTelemetry& total, const KernelCounters& counters) {
+	total.calls += counters.calls.load(std::memory_order_relaxed);
+	total.elements += counters.elements.load(std::memory_order_relaxed);
+	total.ticks += counters.ticks.load(std::memory_order_relaxed);
+	for (int b = 0; b < KernelTelemetry::num_buckets; b++) {
+		total.histogram[b] += counters.histogram[b].load(std::memory_order_relaxed);
+	}
+}
+
+struct ThreadTelemetry {
+	KernelCounters kernels[(int)Kernel::Count];
+
+	ThreadTelemetry() {
+		for (KernelCounters& counters : kernels) {
+			counters.calls.store(0, std::memory_order_relaxed);
+			counters.elements.store(0, std::memory_order_relaxed);
+			counters.ticks.store(0, std::memory_order_relaxed);
+			for (std::atomic<unsigned long long>& bucket : counters.histogram) {
+				bucket.store(0, std::memory_order_relaxed);
+			}
+		}
+		Registry& r = registry();
+		std::lock_guard<std::mutex> lock(r.mutex);
+		r.threads.push_back(this);
+	}
+
+	~ThreadTelemetry() {
+		Registry& r = registry();
+		std::lock_guard<std::mutex> lock(r.mutex);
+		for (int k = 0; k < (int)Kernel::Count; k++) {
+			add_counters(r.retired[k], kernels[k]);
+		}
+		for (size_t i = 0; i < r.threads.size(); i++) {
+			if (r.threads[i] == this) {
+				r.threads[i] = r.threads.back();
+				r.threads.pop_back();
+				break;
+			}
+		}
+	}
+};
+
+static void increment(std::atomic<unsigned long long>& counter, unsigned long long amount) {
+	counter.store(counter.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+}
+
+static int histogram_bucket(unsigned long long ticks) {
+	if (ticks < 2) {
+		return 0;
+	}
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_ARM64))
+	unsigned long index;
+	_BitScanReverse64(&index, ticks);
+	int bucket = (int)index;
+#elif defined(_MSC_VER)
+	// 32 bit targets have no _BitScanReverse64, the high half is scanned first
+	unsigned long index;
+	if (_BitScanReverse(&index, (unsigned long)(ticks >> 32))) {
+		index += 32;
+	}
+	else {
+		_BitScanReverse(&index, (unsigned long)ticks);
+	}
+	int bucket = (int)index;
+#else
+	int bucket = 63 - __builtin_clzll(ticks);
+#endif
+	return bucket < KernelTelemetry::num_buckets ? bucket : KernelTelemetry::num_buckets - 1;
+}
+
+void telemetry_record(Kernel kernel, long long elements, unsigned long long ticks) {
+	static thread_local ThreadTelemetry thread_telemetry;
+
+	KernelCounters& counters = thread_telemetry.kernels[(int)kernel];
+	increment(counters.calls, 1);
+	increment(counters.elements, (unsigned long long)elements);
+	increment(counters.ticks, ticks);
+	increment(counters.histogram[histogram_bucket(ticks)], 1);
+}
+
+bool telemetry_enabled() {
+#ifdef MATHEMATICS_ENGINE_TELEMETRY
+	return true;
+#else
+	return false;
+#endif
+}
+
+// Totals since the start of the process, the registry mutex must be held
+static void totals(const Registry& r, std::vector<KernelTelemetry>& out) {
+	out = r.retired;
+	for (const ThreadTelemetry* thread : r.threads) {
+		for (int k = 0; k < (int)Kernel::Count; k++) {
+			add_counters(out[k], thread->kernels[k]);
+		}
+	}
+}
+
+void telemetry_snapshot(std::vector<KernelTelemetry>& out) {
+	Registry& r = registry();
+	std::lock_guard<std::mutex> lock(r.mutex);
+	totals(r, out);
+
+	// Counters are never cleared, a reset only moves the baseline that snapshots are taken from
+	for (int k = 0; k < (int)Kernel::Count; k++) {
+		out[k].name = kernel_names[k];
+		out[k].calls -= r.baseline[k].calls;
+		out[k].elements -= r.baseline[k].elements;
+		out[k].ticks -= r.baseline[k].ticks;
+		for (int b = 0; b < KernelTelemetry::num_buckets; b++) {
+			out[k].histogram[b] -= r.baseline[k].histogram[b];
+		}
+	}
+}
+
+void telemetry_reset() {
+	Registry& r = registry();
+	std::lock_guard<std::mutex> lock(r.mutex);
+	totals(r, r.baseline);
+}
+
+void telemetry_export(std::ostream& out) {
+	std::vector<KernelTelemetry> snapshot;
+	telemetry_snapshot(snapshot);
+
+	out << "# TYPE mathematics_engine_calls_total counter" << std::endl;
+	for (const KernelTelemetry& kernel : snapshot) {
+		if (kernel.calls > 0) {
+			out << "mathematics_engine_calls_total{kernel=\"" << kernel.name << "\"} " << kernel.calls << std::endl;
+		}
+	}
+
+	out << "# TYPE mathematics_engine_elements_total counter" << std::endl;
+	for (const KernelTelemetry& kernel : snapshot) {
+		if (kernel.calls > 0) {
+			out << "mathematics_engine_elements_total{kernel=\"" << kernel.name << "\"} " << kernel.elements << std::endl;
+		}
+	}
+
+	out << "# TYPE mathematics_engine_latency_ticks histogram" << std::endl;
+	for (const KernelTelemetry& kernel : snapshot) {
+		if (kernel.calls == 0) {
+			continue;
+		}
+		unsigned long long cumulative = 0;
+		for (int b = 0; b < KernelTelemetry::num_buckets - 1; b++) {
+			cumulative += kernel.histogram[b];
+			out << "mathematics_engine_latency_ticks_bucket{kernel=\"" << kernel.name << "\",le=\"" << ((2ull << b) - 1) << "\"} " << cumulative << std::endl;
+		}
+		out << "mathematics_engine_latency_ticks_bucket{kernel=\"" << kernel.name << "\",le=\"+Inf\"} " << kernel.calls << std::endl;
+		out << "mathematics_engine_latency_ticks_sum{kernel=\"" << kernel.name << "\"} " << kernel.ticks << std::endl;
+		out << "mathematics_engine_latency_ticks_count{kernel=\"" << kernel.name << "\"} " << kernel.calls << std::endl;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,62 @@
+#ifndef MATHEMATICS_ENGINE_TELEMETRY_H_
+#define MATHEMATICS_ENGINE_TELEMETRY_H_
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+#include "MathematicsEngine.h"
+
+// Instrumentation used inside the library, see telemetry_snapshot in MathematicsEngine.h.
+
+void telemetry_record(Kernel kernel, long long elements, unsigned long long ticks);
+
+#ifdef MATHEMATICS_ENGINE_TELEMETRY
+
+// Number of instrumented kernels the calling thread is inside of
+inline thread_local int telemetry_depth = 0;
+
+// Times the enclosing scope with the TSC and records it against the kernel on destruction. Only
+// the outermost scope on a thread records, kernels called from inside another kernel are not.
+class TelemetryScope {
+private:
+	Kernel kernel;
+	long long elements;
+	unsigned long long start;
+	bool outermost;
+
+public:
+	TelemetryScope(Kernel kernel, long long elements) : kernel(kernel), elements(elements), start(0), outermost(telemetry_depth++ == 0) {
+		if (outermost) {
+			start = __rdtsc();
+		}
+	}
+
+	~TelemetryScope() {
+		telemetry_depth--;
+		if (outermost) {
+			// The thread may have moved to a core whose TSC is behind, a negative duration counts as 0
+			unsigned long long end = __rdtsc();
+			telemetry_record(kernel, elements, end > start ? end - start : 0);
+		}
+	}
+};
+
+// Marks work a kernel hands to another thread as nested, so that kernels called there are not recorded
+class TelemetryNested {
+public:
+	TelemetryNested() { telemetry_depth++; }
+	~TelemetryNested() { telemetry_depth--; }
+};
+
+#define TELEMETRY_SCOPE(kernel, elements) TelemetryScope telemetry_scope(kernel, elements)
+#define TELEMETRY_NESTED() TelemetryNested telemetry_nested
+
+#else
+
+#define TELEMETRY_SCOPE(kernel, elements)
+#define TELEMETRY_NESTED()
+
+#endif
+
+#endif // MATHEMATICS_ENGINE_TELEMETRY_H_
\ No newline at end of file
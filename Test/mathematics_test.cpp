@@ -1,3 +1,8 @@
+#include <cmath>
+#include <sstream>
+#include <string>
+#include <thread>
+
 #include <gtest/gtest.h>
 #include "../MathematicsEngine/MathematicsEngine.h"
 
@@ -130,4 +135,783 @@ TEST(Vector4Test, DotBatchProduct) {
 		EXPECT_EQ(expected[i], actual[i]);
 	}
 	
+}
+
+TEST(Vector4Test, Normalize) {
+	// Arrange
+	Vector4 a{ 1.0f, 2.0f, 2.0f, 4.0f };
+	Vector4 zero;
+	Vector4 b, c;
+
+	// Act
+	normalize(b, a);
+	normalize(c, zero);
+
+	// Assert
+	EXPECT_NEAR(b.x, 0.2f, 1e-6);
+	EXPECT_NEAR(b.y, 0.4f, 1e-6);
+	EXPECT_NEAR(b.z, 0.4f, 1e-6);
+	EXPECT_NEAR(b.w, 0.8f, 1e-6);
+	EXPECT_EQ(c.x, 0.0f);
+	EXPECT_EQ(c.w, 0.0f);
+}
+
+TEST(PipelineTest, MatchesSeparatePasses) {
+	// Arrange
+	const int num_vectors = 3 * Pipeline::chunk_size + 17;
+	std::vector<Vector4> vectors(num_vectors);
+	for (int i = 0; i < num_vectors; i++) {
+		vectors[i] = Vector4{ (float)(i % 13), 1.0f, (float)(i % 7), 0.0f };
+	}
+	std::vector<Vector4> expected_vectors = vectors;
+	Matrix44 A{ 2.0, 0.0, 0.0, 1.0, 0.0, 3.0, 0.0, 0.0, 0.0, 1.0, 1.0, 0.0, 0.0, 0.0, 0.0, 1.0 };
+	Vector4 b{ 1.0f, 2.0f, 3.0f, 4.0f };
+	std::vector<float> expected(num_vectors);
+	std::vector<float> actual(num_vectors);
+	std::vector<float> actual_threaded(num_vectors);
+
+	multiply_batch(&expected_vectors[0], A, &expected_vectors[0], num_vectors);
+	normalize_batch(&expected_vectors[0], &expected_vectors[0], num_vectors);
+	dot_batch(&expected[0], b, &expected_vectors[0], num_vectors);
+
+	// Act
+	std::vector<Vector4> threaded_vectors = vectors;
+	Pipeline().transform(A).normalize().dot(&actual[0], b).run(&vectors[0], num_vectors);
+	Pipeline().transform(A).normalize().dot(&actual_threaded[0], b).run(&threaded_vectors[0], num_vectors, 4);
+
+	// Assert
+	for (int i = 0; i < num_vectors; i++) {
+		EXPECT_EQ(expected[i], actual[i]);
+		EXPECT_EQ(expected[i], actual_threaded[i]);
+	}
+}
+
+TEST(PipelineTest, CustomStagesPrefetchAndThreads) {
+	// Arrange
+	Matrix44 A{ 2.0, 0.0, 0.0, 1.0, 0.0, 3.0, 0.0, 0.0, 0.0, 1.0, 1.0, 0.0, 0.0, 0.0, 0.0, 1.0 };
+	PipelineStage shift = [](Vector4* vectors, int begin, int end) {
+		for (int i = begin; i < end; i++) {
+			vectors[i].x += 1.0f;
+		}
+	};
+	// Neither multiples of prefetch_step nor of chunk_size
+	const int counts[3] = { 5, Pipeline::prefetch_step * 3 + 7, 2 * Pipeline::chunk_size + 21 };
+
+	for (int num_vectors : counts) {
+		std::vector<Vector4> vectors(num_vectors);
+		for (int i = 0; i < num_vectors; i++) {
+			vectors[i] = Vector4{ (float)(i % 11), 2.0f, (float)(i % 5), 1.0f };
+		}
+		std::vector<Vector4> expected = vectors;
+		shift(&expected[0], 0, num_vectors);
+		multiply_batch(&expected[0], A, &expected[0], num_vectors);
+
+		for (int prefetch : { 0, 256 }) {
+			for (int num_threads : { 1, 3 }) {
+				// Act
+				std::vector<Vector4> actual = vectors;
+				Pipeline().stage(shift).transform(A).prefetch(prefetch).run(&actual[0], num_vectors, num_threads);
+
+				// Assert
+				for (int i = 0; i < num_vectors; i++) {
+					EXPECT_EQ(actual[i].x, expected[i].x);
+					EXPECT_EQ(actual[i].y, expected[i].y);
+					EXPECT_EQ(actual[i].z, expected[i].z);
+					EXPECT_EQ(actual[i].w, expected[i].w);
+				}
+			}
+		}
+	}
+}
+
+TEST(ProjectionTest, ProjectBatch) {
+	// Arrange
+	// Perspective projection with a 90 degree field of view, near = 1 and far = 10
+	Matrix44 mvp{ 1.0f, 0.0f, 0.0f, 0.0f,
+		0.0f, 1.0f, 0.0f, 0.0f,
+		0.0f, 0.0f, -11.0f / 9.0f, -20.0f / 9.0f,
+		0.0f, 0.0f, -1.0f, 0.0f };
+	Viewport viewport(10.0f, 20.0f, 640.0f, 480.0f);
+	Vector4 vertices[5] = {
+		Vector4{ 0.0f, 0.0f, -2.0f, 1.0f },   // on the view axis
+		Vector4{ 1.0f, -2.0f, -4.0f, 1.0f },  // inside
+		Vector4{ -5.0f, 0.0f, -4.0f, 1.0f },  // left of the frustum
+		Vector4{ 0.0f, 5.0f, -4.0f, 1.0f },   // above the frustum
+		Vector4{ 0.0f, 0.0f, -20.0f, 1.0f }   // beyond the far plane
+	};
+	Vector4 out[5];
+	unsigned char clip_flags[5];
+
+	// Act
+	project_batch(out, clip_flags, mvp, vertices, 5, viewport);
+
+	// Assert
+	for (int i = 0; i < 5; i++) {
+		Vector4 clip;
+		multiply(clip, mvp, vertices[i]);
+		EXPECT_NEAR(out[i].x, 10.0f + 320.0f * (clip.x / clip.w + 1.0f), 1e-3);
+		EXPECT_NEAR(out[i].y, 20.0f + 240.0f * (clip.y / clip.w + 1.0f), 1e-3);
+		EXPECT_NEAR(out[i].z, 0.5f * (clip.z / clip.w + 1.0f), 1e-5);
+		EXPECT_NEAR(out[i].w, 1.0f / clip.w, 1e-6);
+	}
+	EXPECT_NEAR(out[0].x, 330.0f, 1e-3);
+	EXPECT_NEAR(out[0].y, 260.0f, 1e-3);
+	EXPECT_EQ(clip_flags[0], 0);
+	EXPECT_EQ(clip_flags[1], 0);
+	EXPECT_EQ(clip_flags[2], CLIP_LEFT);
+	EXPECT_EQ(clip_flags[3], CLIP_TOP);
+	EXPECT_EQ(clip_flags[4], CLIP_FAR);
+}
+
+TEST(ProjectionTest, FlagsVerticesWithoutProjection) {
+	// Arrange
+	Matrix44 mvp{ 1.0f, 0.0f, 0.0f, 0.0f,
+		0.0f, 1.0f, 0.0f, 0.0f,
+		0.0f, 0.0f, -11.0f / 9.0f, -20.0f / 9.0f,
+		0.0f, 0.0f, -1.0f, 0.0f };
+	Viewport viewport(10.0f, 20.0f, 640.0f, 480.0f);
+	Vector4 vertices[2] = {
+		Vector4{ 0.0f, 0.0f, 0.0f, 0.0f }, // clip space origin, w = 0
+		Vector4{ 0.0f, 0.0f, 3.0f, 1.0f }  // behind the eye, w = -3
+	};
+	Vector4 out[2];
+	unsigned char clip_flags[2];
+
+	// Act
+	project_batch(out, clip_flags, mvp, vertices, 2, viewport);
+
+	// Assert
+	EXPECT_EQ(clip_flags[0], CLIP_BEHIND);
+	EXPECT_NE(clip_flags[1] & CLIP_BEHIND, 0);
+}
+
+TEST(PrecisionTest, InverseErrorBounds) {
+	// Arrange
+	Matrix44 matrices44[3] = {
+		Matrix44{ 90.0f, 73.0f, 3.0f, 4.0f, 1.0f, 16.0f, 7.0f, 8.0f, 1.0f, 3.0f, 19.0f, 81.2f, 2.0f, 1.0f, 101.8f, 15.0f },
+		Matrix44{ 10.0f, 7.0f, 9.0f, 32.0f, 8.0f, 3.0f, 10.0f, 82.0f, 81.0f, 37.0f, 39.0f, 1.0f, 92.0f, 9.0f, 7.0f, 2.0f },
+		Matrix44{ 0.5f, -0.25f, 0.0f, 2.0f, 0.125f, 4.0f, -1.0f, 0.0f, 3.0f, 0.0f, 0.75f, -2.0f, 0.0f, 1.5f, 0.25f, 1.0f }
+	};
+	Matrix33 matrices33[3] = {
+		Matrix33(12.0, 2.0, 3.0, 4.0, 16.0, 6.0, 7.0, 8.0, 19.0),
+		Matrix33(0.5, -3.0, 1.0, 2.0, 0.25, -1.0, 4.0, 1.0, 6.0),
+		Matrix33(-7.0, 2.0, 0.0, 1.0, 9.0, 3.0, 0.5, -4.0, 11.0)
+	};
+
+	for (int k = 0; k < 3; k++) {
+		Matrix44 exact44, refined44, approximate44;
+		Matrix33 exact33, refined33, approximate33;
+
+		// Act
+		inverse(exact44, matrices44[k]);
+		inverse(refined44, matrices44[k], Precision::Refined);
+		inverse(approximate44, matrices44[k], Precision::Approximate);
+		inverse(exact33, matrices33[k]);
+		inverse(refined33, matrices33[k], Precision::Refined);
+		inverse(approximate33, matrices33[k], Precision::Approximate);
+
+		// Assert
+		for (int i = 0; i < 16; i++) {
+			EXPECT_NEAR(refined44.m[i], exact44.m[i], 1e-6 * std::fabs(exact44.m[i]));
+			EXPECT_NEAR(approximate44.m[i], exact44.m[i], 3.7e-4 * std::fabs(exact44.m[i]));
+		}
+		for (int i = 0; i < 9; i++) {
+			EXPECT_NEAR(refined33.m[i], exact33.m[i], 1e-6 * std::fabs(exact33.m[i]));
+			EXPECT_NEAR(approximate33.m[i], exact33.m[i], 3.7e-4 * std::fabs(exact33.m[i]));
+		}
+	}
+}
+
+TEST(PrecisionTest, RefinedReciprocalOfZero) {
+	// Arrange
+	// The determinant of the scaled matrix is below FLT_MIN, the inverse overflows to inf
+	Matrix44 tiny{ 90e-12f, 73e-12f, 3e-12f, 4e-12f, 1e-12f, 16e-12f, 7e-12f, 8e-12f, 1e-12f, 3e-12f, 19e-12f, 81.2e-12f, 2e-12f, 1e-12f, 101.8e-12f, 15e-12f };
+	Matrix44 exact, refined;
+	Matrix44 mvp{ 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f };
+	Vector4 vertex{ 1.0f, 2.0f, 3.0f, 1.0f };
+	Vector4 screen;
+	unsigned char clip_flags;
+	Vector4 zero_length[8] = {};
+	Vector4 normalized_exact[8], normalized_refined[8];
+
+	// Act
+	inverse(exact, tiny);
+	inverse(refined, tiny, Precision::Refined);
+	project_batch(&screen, &clip_flags, mvp, &vertex, 1, Viewport(0.0f, 0.0f, 640.0f, 480.0f));
+	normalize_batch(normalized_exact, zero_length, 8);
+	normalize_batch(normalized_refined, zero_length, 8, Precision::Refined);
+
+	// Assert
+	for (int i = 0; i < 16; i++) {
+		EXPECT_TRUE(std::isinf(exact.m[i]));
+		EXPECT_EQ(refined.m[i], exact.m[i]);
+	}
+	EXPECT_TRUE(std::isinf(screen.w));
+	EXPECT_NE(clip_flags & CLIP_BEHIND, 0);
+	for (int i = 0; i < 8; i++) {
+		EXPECT_EQ(std::isnan(normalized_refined[i].x), std::isnan(normalized_exact[i].x));
+	}
+}
+
+TEST(PrecisionTest, NormalizeErrorBounds) {
+	// Arrange
+	const int num_vectors = 1000;
+	Vector4 vectors[num_vectors];
+	for (int i = 0; i < num_vectors; i++) {
+		vectors[i] = Vector4{ 1.0f + i, 0.5f * i, 3.0f - 0.01f * i, -0.25f * i };
+	}
+	Vector4 exact[num_vectors], refined[num_vectors], approximate[num_vectors];
+
+	// Act
+	normalize_batch(exact, vectors, num_vectors);
+	normalize_batch(refined, vectors, num_vectors, Precision::Refined);
+	normalize_batch(approximate, vectors, num_vectors, Precision::Approximate);
+
+	// Assert
+	for (int i = 0; i < num_vectors; i++) {
+		const float* e = (const float*)&exact[i];
+		const float* r = (const float*)&refined[i];
+		const float* a = (const float*)&approximate[i];
+		for (int c = 0; c < 4; c++) {
+			EXPECT_NEAR(r[c], e[c], 1e-6 * std::fabs(e[c]));
+			EXPECT_NEAR(a[c], e[c], 3.7e-4 * std::fabs(e[c]));
+		}
+	}
+}
+
+TEST(Vector3Test, CrossProduct) {
+	// Arrange
+	Vector3 a{ 1.0f, 2.0f, 3.0f };
+	Vector3 b{ 4.0f, 5.0f, 6.0f };
+	Vector3 c;
+
+	// Act
+	cross(c, a, b);
+
+	// Assert
+	EXPECT_EQ(c.x, -3.0f);
+	EXPECT_EQ(c.y, 6.0f);
+	EXPECT_EQ(c.z, -3.0f);
+	EXPECT_EQ(dot(c, a), 0.0f);
+}
+
+TEST(Vector3Test, MatrixVectorMultiplication) {
+	// Arrange
+	Matrix33 A(12.0, 2.0, 3.0, 4.0, 16.0, 6.0, 7.0, 8.0, 19.0);
+	Vector3 x{ 1.0f, 2.0f, 3.0f };
+	Vector3 y;
+
+	// Act
+	multiply(y, A, x);
+
+	// Assert
+	EXPECT_EQ(y.x, 25.0f);
+	EXPECT_EQ(y.y, 54.0f);
+	EXPECT_EQ(y.z, 80.0f);
+}
+
+TEST(Vector3Test, BatchKernelsMatchScalar) {
+	// Arrange
+	const int num_vectors = 37;
+	float ax[num_vectors], ay[num_vectors], az[num_vectors];
+	float bx[num_vectors], by[num_vectors], bz[num_vectors];
+	float cx[num_vectors], cy[num_vectors], cz[num_vectors];
+	float nx[num_vectors], ny[num_vectors], nz[num_vectors];
+	float lx[num_vectors], ly[num_vectors], lz[num_vectors];
+	float mx[num_vectors], my[num_vectors], mz[num_vectors];
+	float ex[num_vectors], ey[num_vectors], ez[num_vectors];
+	float lengths[num_vectors];
+	for (int i = 0; i < num_vectors; i++) {
+		ax[i] = (float)i; ay[i] = 1.0f - i; az[i] = 0.5f * i;
+		bx[i] = 2.0f; by[i] = (float)(i % 5); bz[i] = -1.0f * i;
+	}
+	ax[3] = 0.0f; ay[3] = 0.0f; az[3] = 0.0f;
+	// B only reads the arrays, the kernels take constant inputs
+	Vector3SoA A(ax, ay, az), C(cx, cy, cz), N(nx, ny, nz), L(lx, ly, lz), M(mx, my, mz), E(ex, ey, ez);
+	const float* constant_bx = bx;
+	Vector3SoAConst B(constant_bx, by, bz);
+	Matrix33 R(0.0, -1.0, 0.0, 1.0, 0.0, 0.0, 0.0, 0.0, 2.0);
+
+	// Act
+	cross_batch(C, A, B, num_vectors);
+	length_batch(lengths, A, num_vectors);
+	normalize_batch(N, A, num_vectors, Precision::Refined);
+	lerp_batch(L, A, B, 0.25f, num_vectors);
+	multiply_batch(M, R, A, num_vectors);
+	normalize_batch(E, A, num_vectors);
+
+	// Assert
+	for (int i = 0; i < num_vectors; i++) {
+		Vector3 a{ ax[i], ay[i], az[i] };
+		Vector3 b{ bx[i], by[i], bz[i] };
+		Vector3 expected;
+
+		cross(expected, a, b);
+		EXPECT_NEAR(cx[i], expected.x, 1e-4);
+		EXPECT_NEAR(cy[i], expected.y, 1e-4);
+		EXPECT_NEAR(cz[i], expected.z, 1e-4);
+
+		EXPECT_NEAR(lengths[i], length(a), 1e-5);
+
+		normalize(expected, a);
+		EXPECT_NEAR(nx[i], expected.x, 1e-6);
+		EXPECT_NEAR(ny[i], expected.y, 1e-6);
+		EXPECT_NEAR(nz[i], expected.z, 1e-6);
+
+		// Exact is correctly rounded in both the scalar and the batched kernel
+		float exact_length = std::sqrt(ax[i] * ax[i] + ay[i] * ay[i] + az[i] * az[i]);
+		if (exact_length != 0.0f) {
+			EXPECT_EQ(expected.x, ax[i] / exact_length);
+			EXPECT_EQ(expected.z, az[i] / exact_length);
+		}
+		EXPECT_EQ(ex[i], expected.x);
+		EXPECT_EQ(ey[i], expected.y);
+		EXPECT_EQ(ez[i], expected.z);
+
+		lerp(expected, a, b, 0.25f);
+		EXPECT_NEAR(lx[i], expected.x, 1e-5);
+		EXPECT_NEAR(ly[i], expected.y, 1e-5);
+		EXPECT_NEAR(lz[i], expected.z, 1e-5);
+
+		multiply(expected, R, a);
+		EXPECT_EQ(mx[i], expected.x);
+		EXPECT_EQ(my[i], expected.y);
+		EXPECT_EQ(mz[i], expected.z);
+	}
+	EXPECT_EQ(nx[3], 0.0f);
+}
+
+TEST(SkinningTest, MatchesBlendedTransforms) {
+	// Arrange
+	Matrix44 bones[3] = {
+		Matrix44{ 1.0, 0.0, 0.0, 1.0, 0.0, 1.0, 0.0, 2.0, 0.0, 0.0, 1.0, 3.0, 0.0, 0.0, 0.0, 1.0 },
+		Matrix44{ 0.0, -1.0, 0.0, 0.0, 1.0, 0.0, 0.0, 0.0, 0.0, 0.0, 1.0, -1.0, 0.0, 0.0, 0.0, 1.0 },
+		Matrix44{ 2.0, 0.0, 0.0, 0.0, 0.0, 2.0, 0.0, 5.0, 0.0, 0.0, 2.0, 0.0, 0.0, 0.0, 0.0, 1.0 }
+	};
+	const int num_vertices = 100;
+	std::vector<Vector4> positions(num_vertices), normals(num_vertices);
+	std::vector<Vector4> out_positions(num_vertices), out_normals(num_vertices);
+	std::vector<SkinWeights> weights(num_vertices);
+	for (int i = 0; i < num_vertices; i++) {
+		positions[i] = Vector4{ (float)i, 1.0f, -0.5f * i, 1.0f };
+		normals[i] = Vector4{ 0.0f, 1.0f, 0.0f, 0.0f };
+		weights[i] = SkinWeights(i % 3, (i + 1) % 3, (i + 2) % 3, 0, 0.5f, 0.25f, 0.25f, 0.0f);
+	}
+
+	// Act
+	skin_batch(&out_positions[0], &out_normals[0], bones, 3, &weights[0], &positions[0], &normals[0], num_vertices, 3);
+
+	// Assert
+	for (int i = 0; i < num_vertices; i++) {
+		Vector4 expected_position, expected_normal;
+		for (int k = 0; k < 4; k++) {
+			Vector4 position, normal;
+			multiply(position, bones[weights[i].bone[k]], positions[i]);
+			multiply(normal, bones[weights[i].bone[k]], normals[i]);
+			expected_position.x += weights[i].weight[k] * position.x;
+			expected_position.y += weights[i].weight[k] * position.y;
+			expected_position.z += weights[i].weight[k] * position.z;
+			expected_position.w += weights[i].weight[k] * position.w;
+			expected_normal.x += weights[i].weight[k] * normal.x;
+			expected_normal.y += weights[i].weight[k] * normal.y;
+			expected_normal.z += weights[i].weight[k] * normal.z;
+		}
+		EXPECT_NEAR(out_positions[i].x, expected_position.x, 1e-4);
+		EXPECT_NEAR(out_positions[i].y, expected_position.y, 1e-4);
+		EXPECT_NEAR(out_positions[i].z, expected_position.z, 1e-4);
+		EXPECT_NEAR(out_positions[i].w, expected_position.w, 1e-4);
+		EXPECT_NEAR(out_normals[i].x, expected_normal.x, 1e-4);
+		EXPECT_NEAR(out_normals[i].y, expected_normal.y, 1e-4);
+		EXPECT_NEAR(out_normals[i].z, expected_normal.z, 1e-4);
+	}
+}
+
+TEST(SkinningTest, SkinsPositionsOnly) {
+	// Arrange
+	Matrix44 bones[2] = {
+		Matrix44{ 1.0, 0.0, 0.0, 1.0, 0.0, 1.0, 0.0, 2.0, 0.0, 0.0, 1.0, 3.0, 0.0, 0.0, 0.0, 1.0 },
+		Matrix44{ 0.0, -1.0, 0.0, 0.0, 1.0, 0.0, 0.0, 0.0, 0.0, 0.0, 1.0, -1.0, 0.0, 0.0, 0.0, 1.0 }
+	};
+	const int num_vertices = 10;
+	std::vector<Vector4> positions(num_vertices), normals(num_vertices, Vector4{ 0.0f, 1.0f, 0.0f, 0.0f });
+	std::vector<Vector4> expected(num_vertices), normals_null(num_vertices), out_normals_null(num_vertices);
+	std::vector<SkinWeights> weights(num_vertices);
+	for (int i = 0; i < num_vertices; i++) {
+		positions[i] = Vector4{ (float)i, 1.0f, -0.5f * i, 1.0f };
+		weights[i] = SkinWeights(i % 2, (i + 1) % 2, 0, 0, 0.75f, 0.25f, 0.0f, 0.0f);
+	}
+	std::vector<Vector4> out_normals(num_vertices);
+	skin_batch(&expected[0], &out_normals[0], bones, 2, &weights[0], &positions[0], &normals[0], num_vertices);
+	const Vector4 untouched{ -7.0f, -7.0f, -7.0f, -7.0f };
+	std::vector<Vector4> unused_normals(num_vertices, untouched);
+
+	// Act
+	skin_batch(&normals_null[0], &unused_normals[0], bones, 2, &weights[0], &positions[0], nullptr, num_vertices);
+	skin_batch(&out_normals_null[0], nullptr, bones, 2, &weights[0], &positions[0], &normals[0], num_vertices);
+
+	// Assert
+	for (int i = 0; i < num_vertices; i++) {
+		EXPECT_EQ(normals_null[i].x, expected[i].x);
+		EXPECT_EQ(normals_null[i].y, expected[i].y);
+		EXPECT_EQ(normals_null[i].z, expected[i].z);
+		EXPECT_EQ(normals_null[i].w, expected[i].w);
+		EXPECT_EQ(out_normals_null[i].x, expected[i].x);
+		EXPECT_EQ(out_normals_null[i].y, expected[i].y);
+		EXPECT_EQ(out_normals_null[i].z, expected[i].z);
+		EXPECT_EQ(out_normals_null[i].w, expected[i].w);
+
+		// Without input normals the output normals are not written
+		EXPECT_EQ(unused_normals[i].x, untouched.x);
+		EXPECT_EQ(unused_normals[i].y, untouched.y);
+		EXPECT_EQ(unused_normals[i].z, untouched.z);
+		EXPECT_EQ(unused_normals[i].w, untouched.w);
+	}
+}
+
+TEST(ConstexprTest, TransformChainFoldsAtCompileTime) {
+	// Arrange
+	constexpr Matrix44 model = multiply(translation(1.0f, 2.0f, 3.0f), scaling(2.0f, 2.0f, 2.0f));
+	constexpr Vector4 point = multiply(model, Vector4(1.0f, 1.0f, 1.0f, 1.0f));
+	constexpr Matrix44 rotated = transpose(rotation_z(1.5707963f));
+	constexpr Matrix33 product = multiply(identity33(), transpose(Matrix33(1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f, 8.0f, 9.0f)));
+
+	// Assert
+	static_assert(point.x == 3.0f && point.y == 4.0f && point.z == 5.0f && point.w == 1.0f, "constant transform chain");
+	static_assert(product.m[1] == 4.0f && product.m[3] == 2.0f, "constant Matrix33 chain");
+	static_assert(rotated.m[1] > 0.9999f && rotated.m[4] < -0.9999f, "constant rotation");
+
+	// Runtime calls give the same results through the SIMD kernels
+	Matrix44 runtime_model = multiply(translation(1.0f, 2.0f, 3.0f), scaling(2.0f, 2.0f, 2.0f));
+	Vector4 runtime_point = multiply(runtime_model, Vector4(1.0f, 1.0f, 1.0f, 1.0f));
+	Matrix33 runtime_product = multiply(identity33(), transpose(Matrix33(1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f, 8.0f, 9.0f)));
+	for (int i = 0; i < 16; i++) {
+		EXPECT_EQ(runtime_model.m[i], model.m[i]);
+	}
+	for (int i = 0; i < 9; i++) {
+		EXPECT_EQ(runtime_product.m[i], product.m[i]);
+	}
+	EXPECT_EQ(runtime_point.x, point.x);
+	EXPECT_EQ(runtime_point.y, point.y);
+	EXPECT_EQ(runtime_point.z, point.z);
+	EXPECT_EQ(runtime_point.w, point.w);
+	EXPECT_NEAR(sine(0.5f), std::sin(0.5f), 1e-6);
+	EXPECT_NEAR(rotation_x(2.0f).m[5], std::cos(2.0f), 1e-6);
+}
+
+TEST(ReductionTest, BoundsMeanAndCovariance) {
+	// Arrange
+	const int num_points = 1001;
+	std::vector<Vector4> points(num_points);
+	for (int i = 0; i < num_points; i++) {
+		float t = (float)(i - 500);
+		points[i] = Vector4{ 100.0f + t, 50.0f - 2.0f * t, (float)(i % 2), 1.0f };
+	}
+	Vector4 min, max, centroid, covariance_mean;
+	Matrix33 C;
+
+	// Act
+	bounds(min, max, &points[0], num_points, 3);
+	mean(centroid, &points[0], num_points, Summation::Kahan, 3);
+	covariance(C, covariance_mean, &points[0], num_points, Summation::Pairwise, 3);
+
+	// Assert
+	EXPECT_EQ(min.x, -400.0f);
+	EXPECT_EQ(max.x, 600.0f);
+	EXPECT_EQ(min.y, -950.0f);
+	EXPECT_EQ(max.y, 1050.0f);
+	EXPECT_EQ(min.z, 0.0f);
+	EXPECT_EQ(max.z, 1.0f);
+	EXPECT_NEAR(centroid.x, 100.0f, 1e-4);
+	EXPECT_NEAR(centroid.y, 50.0f, 1e-4);
+	EXPECT_NEAR(covariance_mean.x, 100.0f, 1e-4);
+	EXPECT_NEAR(covariance_mean.w, 1.0f, 1e-6);
+
+	// var(t) = (500 * 501 * 1001) / (3 * 1001) for t = -500..500
+	float variance = 500.0f * 501.0f / 3.0f;
+	EXPECT_NEAR(C.m[0], variance, 1e-5 * variance);
+	EXPECT_NEAR(C.m[1], -2.0f * variance, 2e-5 * variance);
+	EXPECT_NEAR(C.m[3], -2.0f * variance, 2e-5 * variance);
+	EXPECT_NEAR(C.m[4], 4.0f * variance, 4e-5 * variance);
+	EXPECT_NEAR(C.m[8], 0.25f, 1e-3);
+}
+
+TEST(ReductionTest, CovarianceWithOutlyingFirstPoint) {
+	// Arrange
+	// The moments are taken about the first point. Put it far from a tight cluster so the shifted
+	// moments are large compared to the covariance, then check against a two pass reference.
+	const int num_points = 100001;
+	std::vector<Vector4> points(num_points);
+	points[0] = Vector4{ 20000.0f, -20000.0f, 20000.0f, 1.0f };
+	for (int i = 1; i < num_points; i++) {
+		float t = (float)(i % 101 - 50) / 100.0f;
+		points[i] = Vector4{ 1000.0f + t, 1000.0f - t, 1000.0f + (float)(i % 3), 1.0f };
+	}
+
+	double centre[3] = {};
+	for (const Vector4& p : points) {
+		centre[0] += p.x;
+		centre[1] += p.y;
+		centre[2] += p.z;
+	}
+	for (double& c : centre) {
+		c /= num_points;
+	}
+	double expected[9] = {};
+	for (const Vector4& p : points) {
+		double d[3] = { p.x - centre[0], p.y - centre[1], p.z - centre[2] };
+		for (int r = 0; r < 3; r++) {
+			for (int c = 0; c < 3; c++) {
+				expected[r * 3 + c] += d[r] * d[c] / num_points;
+			}
+		}
+	}
+	Vector4 covariance_mean;
+	Matrix33 C;
+
+	// Act
+	covariance(C, covariance_mean, &points[0], num_points, Summation::Naive, 4);
+
+	// Assert
+	for (int i = 0; i < 9; i++) {
+		EXPECT_NEAR(C.m[i], expected[i], 1e-4 * std::abs(expected[i]) + 1e-4) << "element " << i;
+	}
+	EXPECT_NEAR(covariance_mean.x, centre[0], 1e-3);
+	EXPECT_NEAR(covariance_mean.y, centre[1], 1e-3);
+	EXPECT_NEAR(covariance_mean.z, centre[2], 1e-3);
+}
+
+TEST(ReductionTest, CompensatedSummationAccuracy) {
+	// Arrange
+	// Summing 0.1 four million times in float drifts far from the exact result. The Kahan sum
+	// should be within a few ulps of it and the pairwise sum within log2(n) * epsilon.
+	const int num_points = 4000000;
+	std::vector<Vector4> points(num_points, Vector4{ 0.1f, 1.0f, 0.0f, 0.0f });
+	double expected = (double)0.1f * num_points;
+	Vector4 naive, kahan, pairwise;
+
+	// Act
+	sum(naive, &points[0], num_points);
+	sum(kahan, &points[0], num_points, Summation::Kahan);
+	sum(pairwise, &points[0], num_points, Summation::Pairwise, 2);
+
+	// Assert
+	EXPECT_GT(std::fabs(naive.x - expected), 1e-4 * expected);
+	EXPECT_NEAR(kahan.x, expected, 1e-6 * expected);
+	EXPECT_NEAR(pairwise.x, expected, 1e-5 * expected);
+	EXPECT_EQ(kahan.y, (float)num_points);
+}
+
+TEST(ColumnMajorTest, MatchesRowMajor) {
+	// Arrange
+	Matrix44 A{ 90.0f, 73.0f, 3.0f, 4.0f, 1.0f, 16.0f, 7.0f, 8.0f, 1.0f, 3.0f, 19.0f, 81.2f, 2.0f, 1.0f, 101.8f, 15.0f };
+	Matrix44 B(10, 7, 9, 32, 8, 3, 10, 82, 81, 37, 39, 1, 92, 9, 7, 2);
+	Matrix44ColumnMajor A_col, B_col, product_col, inverse_col;
+	Matrix44 product, inverse_row, product_back, inverse_back;
+	Vector4 x{ 2.0f, 3.0f, 4.0f, 5.0f };
+	Vector4 y_row, y_col, y_batch;
+
+	// Act
+	convert(A_col, A);
+	convert(B_col, B);
+	multiply(product, A, B);
+	multiply(product_col, A_col, B_col);
+	convert(product_back, product_col);
+	inverse(inverse_row, A);
+	inverse(inverse_col, A_col);
+	convert(inverse_back, inverse_col);
+	multiply(y_row, A, x);
+	multiply(y_col, A_col, x);
+	multiply_batch(&y_batch, A_col, &x, 1);
+
+	// Assert
+	EXPECT_EQ(A_col.m[1], A.m[4]);
+	EXPECT_EQ(A_col.m[4], A.m[1]);
+	EXPECT_EQ(&transposed_view(A).m[0], &A.m[0]);
+	EXPECT_EQ(transposed_view(A_col).m[1], A.m[4]);
+	for (int i = 0; i < 16; i++) {
+		EXPECT_EQ(product_back.m[i], product.m[i]);
+		EXPECT_NEAR(inverse_back.m[i], inverse_row.m[i], 1e-5 * std::fabs(inverse_row.m[i]));
+	}
+	EXPECT_EQ(y_col.x, y_row.x);
+	EXPECT_EQ(y_col.y, y_row.y);
+	EXPECT_EQ(y_col.z, y_row.z);
+	EXPECT_EQ(y_col.w, y_row.w);
+	EXPECT_EQ(y_batch.w, y_row.w);
+}
+
+TEST(ColumnMajorTest, ViewsShareStorage) {
+	// Arrange
+	Matrix44 A{ 90.0f, 73.0f, 3.0f, 4.0f, 1.0f, 16.0f, 7.0f, 8.0f, 1.0f, 3.0f, 19.0f, 81.2f, 2.0f, 1.0f, 101.8f, 15.0f };
+	Matrix44 A_transposed;
+	Matrix44ColumnMajor A_col, C;
+	Vector4 x{ 2.0f, 3.0f, 4.0f, 5.0f };
+	Vector4 expected, y_row_view, y_col_view, y_batch;
+	C.m[1] = 1.0f;
+	transpose(A_transposed, A);
+	convert(A_col, A);
+	multiply(expected, A_transposed, x);
+
+	// Act
+	transposed_view(C).m[1] = 2.0f;
+	float written_through_view = C.m[1];
+	C.m[2] = 3.0f;
+	float read_through_view = transposed_view(C).m[2];
+	multiply(y_row_view, transposed_view(A_col), x);
+	multiply(y_col_view, transposed_view(A), x);
+	multiply_batch(&y_batch, transposed_view(A), &x, 1);
+
+	// Assert
+	EXPECT_EQ(written_through_view, 2.0f);
+	EXPECT_EQ(read_through_view, 3.0f);
+	EXPECT_EQ(y_row_view.x, expected.x);
+	EXPECT_EQ(y_row_view.y, expected.y);
+	EXPECT_EQ(y_row_view.z, expected.z);
+	EXPECT_EQ(y_row_view.w, expected.w);
+	EXPECT_EQ(y_col_view.x, expected.x);
+	EXPECT_EQ(y_col_view.w, expected.w);
+	EXPECT_EQ(y_batch.x, expected.x);
+	EXPECT_EQ(y_batch.w, expected.w);
+}
+
+TEST(ColumnMajorTest, MatrixKernelsThroughViews) {
+	// Arrange
+	// Through a view a matrix is its own transpose in the other layout, so B^T A^T written through
+	// a view is the product AB, and similarly for the inverse and the transpose.
+	Matrix44 A{ 90.0f, 73.0f, 3.0f, 4.0f, 1.0f, 16.0f, 7.0f, 8.0f, 1.0f, 3.0f, 19.0f, 81.2f, 2.0f, 1.0f, 101.8f, 15.0f };
+	Matrix44 B(10, 7, 9, 32, 8, 3, 10, 82, 81, 37, 39, 1, 92, 9, 7, 2);
+	Matrix44ColumnMajor A_col, B_col;
+	Matrix44 product, inverse_row, transposed;
+	Matrix44 product_view, inverse_view, transposed_view_out;
+	Matrix44ColumnMajor product_col, product_col_view, inverse_col, inverse_col_view;
+	convert(A_col, A);
+	convert(B_col, B);
+	multiply(product, A, B);
+	inverse(inverse_row, A);
+	transpose(transposed, A);
+	multiply(product_col, A_col, B_col);
+	inverse(inverse_col, A_col);
+
+	// Act
+	multiply(transposed_view(product_view), transposed_view(B), transposed_view(A));
+	inverse(transposed_view(inverse_view), transposed_view(A));
+	transpose(transposed_view(transposed_view_out), transposed_view(A));
+	multiply(transposed_view(product_col_view), transposed_view(B_col), transposed_view(A_col));
+	inverse(transposed_view(inverse_col_view), transposed_view(A_col));
+
+	// Assert
+	for (int i = 0; i < 16; i++) {
+		EXPECT_EQ(product_view.m[i], product.m[i]);
+		EXPECT_EQ(inverse_view.m[i], inverse_row.m[i]);
+		EXPECT_EQ(transposed_view_out.m[i], transposed.m[i]);
+		EXPECT_EQ(product_col_view.m[i], product_col.m[i]);
+		EXPECT_EQ(inverse_col_view.m[i], inverse_col.m[i]);
+	}
+}
+
+TEST(TelemetryTest, CountsCallsAndElements) {
+	// Arrange
+	Vector4 a{ 4.0f, 3.0f, 2.0f, 1.0f };
+	Vector4 b[50];
+	float d[50];
+	Matrix44 M{ 90.0f, 73.0f, 3.0f, 4.0f, 1.0f, 16.0f, 7.0f, 8.0f, 1.0f, 3.0f, 19.0f, 81.2f, 2.0f, 1.0f, 101.8f, 15.0f };
+	Vector4 transformed[50];
+	Vector4 average;
+	Pipeline pipeline;
+	pipeline.transform(M);
+	std::vector<KernelTelemetry> snapshot;
+	telemetry_reset();
+
+	// Act
+	dot_batch(d, a, b, 50);
+	dot_batch(d, a, b, 20);
+	mean(average, b, 50);
+	pipeline.run(b, 50, 2);
+	std::thread worker([&]() {
+		multiply_batch(transformed, M, b, 50);
+	});
+	worker.join();
+	telemetry_snapshot(snapshot);
+
+	// Assert
+	ASSERT_EQ(snapshot.size(), (size_t)Kernel::Count);
+	const KernelTelemetry& dots = snapshot[(int)Kernel::DotBatch4];
+	const KernelTelemetry& batches = snapshot[(int)Kernel::MultiplyBatch44];
+	EXPECT_STREQ(dots.name, "dot_batch4");
+	if (telemetry_enabled()) {
+		unsigned long long histogram_calls = 0;
+		for (int b = 0; b < KernelTelemetry::num_buckets; b++) {
+			histogram_calls += dots.histogram[b];
+		}
+		EXPECT_EQ(dots.calls, 2u);
+		EXPECT_EQ(dots.elements, 70u);
+		EXPECT_EQ(histogram_calls, 2u);
+		EXPECT_EQ(batches.calls, 1u);
+		EXPECT_EQ(batches.elements, 50u);
+
+		// Kernels called by other kernels are only counted against the outer kernel
+		EXPECT_EQ(snapshot[(int)Kernel::Mean].calls, 1u);
+		EXPECT_EQ(snapshot[(int)Kernel::Sum].calls, 0u);
+		EXPECT_EQ(snapshot[(int)Kernel::PipelineRun].calls, 1u);
+	}
+	else {
+		EXPECT_EQ(dots.calls, 0u);
+		EXPECT_EQ(batches.calls, 0u);
+	}
+
+	// A reset starts the counts again from zero
+	telemetry_reset();
+	telemetry_snapshot(snapshot);
+	EXPECT_EQ(snapshot[(int)Kernel::DotBatch4].calls, 0u);
+}
+
+TEST(TelemetryTest, ExportsPrometheusText) {
+	if (!telemetry_enabled()) {
+		GTEST_SKIP() << "built without MATHEMATICS_ENGINE_TELEMETRY";
+	}
+
+	// Arrange
+	Vector4 a{ 4.0f, 3.0f, 2.0f, 1.0f };
+	Vector4 b[10];
+	float d[10];
+	std::vector<KernelTelemetry> snapshot;
+	std::ostringstream text;
+	telemetry_reset();
+
+	// Act
+	for (int i = 0; i < 3; i++) {
+		dot_batch(d, a, b, 10);
+	}
+	telemetry_snapshot(snapshot);
+	telemetry_export(text);
+
+	// Assert
+	std::string exported = text.str();
+	EXPECT_NE(exported.find("# TYPE mathematics_engine_calls_total counter\n"), std::string::npos);
+	EXPECT_NE(exported.find("mathematics_engine_calls_total{kernel=\"dot_batch4\"} 3\n"), std::string::npos);
+	EXPECT_NE(exported.find("mathematics_engine_elements_total{kernel=\"dot_batch4\"} 30\n"), std::string::npos);
+	EXPECT_NE(exported.find("# TYPE mathematics_engine_latency_ticks histogram\n"), std::string::npos);
+	EXPECT_NE(exported.find("mathematics_engine_latency_ticks_bucket{kernel=\"dot_batch4\",le=\"+Inf\"} 3\n"), std::string::npos);
+	EXPECT_NE(exported.find("mathematics_engine_latency_ticks_count{kernel=\"dot_batch4\"} 3\n"), std::string::npos);
+	std::string ticks = "mathematics_engine_latency_ticks_sum{kernel=\"dot_batch4\"} " + std::to_string(snapshot[(int)Kernel::DotBatch4].ticks) + "\n";
+	EXPECT_NE(exported.find(ticks), std::string::npos);
+
+	// Kernels that were not called are left out
+	EXPECT_EQ(exported.find("kernel=\"covariance\""), std::string::npos);
+
+	// The bucket lines are cumulative, the one for bucket b holds the calls taking at most 2^(b+1) - 1 ticks
+	std::istringstream lines(exported);
+	std::string line;
+	std::string prefix = "mathematics_engine_latency_ticks_bucket{kernel=\"dot_batch4\",le=\"";
+	unsigned long long expected = 0;
+	int buckets = 0;
+	while (std::getline(lines, line)) {
+		if (line.compare(0, prefix.size(), prefix) != 0 || line.find("+Inf") != std::string::npos) {
+			continue;
+		}
+		expected += snapshot[(int)Kernel::DotBatch4].histogram[buckets];
+		std::string bound = std::to_string((2ull << buckets) - 1);
+		EXPECT_EQ(line, prefix + bound + "\"} " + std::to_string(expected));
+		buckets++;
+	}
+	EXPECT_EQ(buckets, KernelTelemetry::num_buckets - 1);
 }
\ No newline at end of file
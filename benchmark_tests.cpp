@@ -64,6 +64,26 @@ void BENCHMARK_MATRIX_INVERSE() {
 			inverse(I, M);
 		}
 	}
+
+	std::cout << std::endl << "Time for Matrix44_s (refined): " << std::endl;
+	{
+		Matrix44 M(90.0, 73.0, 3.0, 4.0, 1.0, 16.0, 7.0, 8.0, 1.0, 3.0, 19.0, 81.2, 2.0, 1.0, 101.8, 15.0);
+		Matrix44 I;
+		Timer timer;
+		for (int i = 0; i < 1000000; i++) {
+			inverse(I, M, Precision::Refined);
+		}
+	}
+
+	std::cout << std::endl << "Time for Matrix44_s (approximate): " << std::endl;
+	{
+		Matrix44 M(90.0, 73.0, 3.0, 4.0, 1.0, 16.0, 7.0, 8.0, 1.0, 3.0, 19.0, 81.2, 2.0, 1.0, 101.8, 15.0);
+		Matrix44 I;
+		Timer timer;
+		for (int i = 0; i < 1000000; i++) {
+			inverse(I, M, Precision::Approximate);
+		}
+	}
 }
 
 
@@ -149,4 +169,311 @@ void BENCHMARK_VECTOR_DOT() {
 		}
 	}
 
+}
+
+void BENCHMARK_VECTOR_NORMALIZE() {
+
+	std::cout << std::endl;
+	std::cout << "-----------------------" << std::endl;
+	std::cout << "BENCHMARK_VECTOR_NORMALIZE" << std::endl;
+	std::cout << "-----------------------" << std::endl;
+
+	Vector4 A[50];
+	Vector4 B[50];
+	for (int i = 0; i < 50; i++) {
+		A[i] = Vector4{ 1.0f, 2.0f, 3.0f, (float)i };
+	}
+
+	std::cout << std::endl << "Time for normalize batch (exact): " << std::endl;
+	{
+		Timer timer;
+		for (int i = 0; i < 1000000; i++) {
+			normalize_batch(B, A, 50);
+		}
+	}
+
+	std::cout << std::endl << "Time for normalize batch (refined): " << std::endl;
+	{
+		Timer timer;
+		for (int i = 0; i < 1000000; i++) {
+			normalize_batch(B, A, 50, Precision::Refined);
+		}
+	}
+
+	std::cout << std::endl << "Time for normalize batch (approximate): " << std::endl;
+	{
+		Timer timer;
+		for (int i = 0; i < 1000000; i++) {
+			normalize_batch(B, A, 50, Precision::Approximate);
+		}
+	}
+
+}
+
+void BENCHMARK_PIPELINE() {
+
+	std::cout << std::endl;
+	std::cout << "-----------------------" << std::endl;
+	std::cout << "BENCHMARK_PIPELINE" << std::endl;
+	std::cout << "-----------------------" << std::endl;
+
+	const int num_vectors = 10000000;
+	Matrix44 A(1.0, 0.0, 0.0, 0.0, 0.0, 1.0, 0.0, 0.0, 0.0, 0.0, 1.0, 0.0, 1.0, 2.0, 3.0, 1.0);
+	Vector4 B(9.0, 12.0, 7.0, 8.0);
+	std::vector<Vector4> vectors(num_vectors, Vector4{ 1.0f, 2.0f, 3.0f, 1.0f });
+	std::vector<float> d(num_vectors);
+
+	std::cout << std::endl << "Time for separate passes: " << std::endl;
+	{
+		Timer timer;
+		multiply_batch(&vectors[0], A, &vectors[0], num_vectors);
+		normalize_batch(&vectors[0], &vectors[0], num_vectors);
+		dot_batch(&d[0], B, &vectors[0], num_vectors);
+	}
+
+	std::cout << std::endl << "Time for pipeline: " << std::endl;
+	{
+		Pipeline pipeline;
+		pipeline.transform(A).normalize().dot(&d[0], B);
+		Timer timer;
+		pipeline.run(&vectors[0], num_vectors);
+	}
+
+	std::cout << std::endl << "Time for pipeline without prefetch: " << std::endl;
+	{
+		Pipeline pipeline;
+		pipeline.transform(A).normalize().dot(&d[0], B).prefetch(0);
+		Timer timer;
+		pipeline.run(&vectors[0], num_vectors);
+	}
+
+	std::cout << std::endl << "Time for pipeline (4 threads): " << std::endl;
+	{
+		Pipeline pipeline;
+		pipeline.transform(A).normalize().dot(&d[0], B);
+		Timer timer;
+		pipeline.run(&vectors[0], num_vectors, 4);
+	}
+
+}
+
+void BENCHMARK_PROJECTION() {
+
+	std::cout << std::endl;
+	std::cout << "-----------------------" << std::endl;
+	std::cout << "BENCHMARK_PROJECTION" << std::endl;
+	std::cout << "-----------------------" << std::endl;
+
+	const int num_vertices = 1000000;
+	Matrix44 mvp(1.0, 0.0, 0.0, 0.0, 0.0, 1.0, 0.0, 0.0, 0.0, 0.0, -1.2, -2.2, 0.0, 0.0, -1.0, 0.0);
+	Viewport viewport(0.0f, 0.0f, 1920.0f, 1080.0f);
+	std::vector<Vector4> vertices(num_vertices, Vector4{ 1.0f, 2.0f, -3.0f, 1.0f });
+	std::vector<Vector4> screen(num_vertices);
+	std::vector<unsigned char> clip_flags(num_vertices);
+
+	std::cout << std::endl << "Time for multiply and divide: " << std::endl;
+	{
+		Timer timer;
+		for (int i = 0; i < num_vertices; i++) {
+			Vector4 clip;
+			multiply(clip, mvp, vertices[i]);
+			float reciprocal_w = 1.0f / clip.w;
+			screen[i] = Vector4{ 960.0f * (clip.x * reciprocal_w + 1.0f), 540.0f * (clip.y * reciprocal_w + 1.0f), 0.5f * (clip.z * reciprocal_w + 1.0f), reciprocal_w };
+		}
+	}
+
+	std::cout << std::endl << "Time for project batch: " << std::endl;
+	{
+		Timer timer;
+		project_batch(&screen[0], &clip_flags[0], mvp, &vertices[0], num_vertices, viewport);
+	}
+
+}
+
+void BENCHMARK_VECTOR3() {
+
+	std::cout << std::endl;
+	std::cout << "-----------------------" << std::endl;
+	std::cout << "BENCHMARK_VECTOR3" << std::endl;
+	std::cout << "-----------------------" << std::endl;
+
+	const int num_vectors = 1024;
+	Vector3 A[num_vectors];
+	std::vector<float> x(num_vectors, 1.0f), y(num_vectors, 2.0f), z(num_vectors, 3.0f);
+	std::vector<float> ox(num_vectors), oy(num_vectors), oz(num_vectors);
+	Vector3SoA vectors(&x[0], &y[0], &z[0]);
+	Vector3SoA out(&ox[0], &oy[0], &oz[0]);
+	for (int i = 0; i < num_vectors; i++) {
+		A[i] = Vector3{ 1.0f, 2.0f, 3.0f };
+	}
+
+	std::cout << std::endl << "Time for normalize: " << std::endl;
+	{
+		Timer timer;
+		for (int i = 0; i < 10000; i++) {
+			for (int j = 0; j < num_vectors; j++) {
+				normalize(A[j], A[j]);
+			}
+		}
+	}
+
+	std::cout << std::endl << "Time for normalize batch (refined): " << std::endl;
+	{
+		Timer timer;
+		for (int i = 0; i < 10000; i++) {
+			normalize_batch(out, vectors, num_vectors, Precision::Refined);
+		}
+	}
+
+	std::cout << std::endl << "Time for cross batch: " << std::endl;
+	{
+		Timer timer;
+		for (int i = 0; i < 10000; i++) {
+			cross_batch(out, vectors, out, num_vectors);
+		}
+	}
+
+}
+
+void BENCHMARK_SKINNING() {
+
+	std::cout << std::endl;
+	std::cout << "-----------------------" << std::endl;
+	std::cout << "BENCHMARK_SKINNING" << std::endl;
+	std::cout << "-----------------------" << std::endl;
+
+	const int num_bones = 64;
+	const int num_vertices = 1000000;
+	std::vector<Matrix44> bones(num_bones, Matrix44(1.0, 0.0, 0.0, 1.0, 0.0, 1.0, 0.0, 2.0, 0.0, 0.0, 1.0, 3.0, 0.0, 0.0, 0.0, 1.0));
+	std::vector<SkinWeights> weights(num_vertices);
+	std::vector<Vector4> positions(num_vertices, Vector4{ 1.0f, 2.0f, 3.0f, 1.0f });
+	std::vector<Vector4> normals(num_vertices, Vector4{ 0.0f, 1.0f, 0.0f, 0.0f });
+	std::vector<Vector4> out_positions(num_vertices), out_normals(num_vertices);
+	for (int i = 0; i < num_vertices; i++) {
+		weights[i] = SkinWeights(i % num_bones, (i + 1) % num_bones, (i + 2) % num_bones, (i + 3) % num_bones, 0.4f, 0.3f, 0.2f, 0.1f);
+	}
+
+	std::cout << std::endl << "Time for multiply per bone: " << std::endl;
+	{
+		Timer timer;
+		for (int i = 0; i < num_vertices; i++) {
+			Vector4 position, normal;
+			for (int k = 0; k < 4; k++) {
+				Vector4 p, n;
+				multiply(p, bones[weights[i].bone[k]], positions[i]);
+				multiply(n, bones[weights[i].bone[k]], normals[i]);
+				float w = weights[i].weight[k];
+				position = Vector4{ position.x + w * p.x, position.y + w * p.y, position.z + w * p.z, position.w + w * p.w };
+				normal = Vector4{ normal.x + w * n.x, normal.y + w * n.y, normal.z + w * n.z, 0.0f };
+			}
+			out_positions[i] = position;
+			out_normals[i] = normal;
+		}
+	}
+
+	std::cout << std::endl << "Time for skin batch: " << std::endl;
+	{
+		Timer timer;
+		skin_batch(&out_positions[0], &out_normals[0], &bones[0], num_bones, &weights[0], &positions[0], &normals[0], num_vertices);
+	}
+
+}
+
+void BENCHMARK_REDUCTION() {
+
+	std::cout << std::endl;
+	std::cout << "-----------------------" << std::endl;
+	std::cout << "BENCHMARK_REDUCTION" << std::endl;
+	std::cout << "-----------------------" << std::endl;
+
+	const int num_points = 10000000;
+	std::vector<Vector4> points(num_points);
+	for (int i = 0; i < num_points; i++) {
+		points[i] = Vector4{ (float)(i % 1000), (float)(i % 7), (float)(i % 13), 1.0f };
+	}
+	Vector4 min, max, centroid;
+	Matrix33 C;
+
+	std::cout << std::endl << "Time for bounds: " << std::endl;
+	{
+		Timer timer;
+		bounds(min, max, &points[0], num_points);
+	}
+
+	std::cout << std::endl << "Time for covariance (naive): " << std::endl;
+	{
+		Timer timer;
+		covariance(C, centroid, &points[0], num_points);
+	}
+
+	std::cout << std::endl << "Time for covariance (kahan): " << std::endl;
+	{
+		Timer timer;
+		covariance(C, centroid, &points[0], num_points, Summation::Kahan);
+	}
+
+	std::cout << std::endl << "Time for covariance (pairwise): " << std::endl;
+	{
+		Timer timer;
+		covariance(C, centroid, &points[0], num_points, Summation::Pairwise);
+	}
+
+}
+
+void BENCHMARK_MATRIX_VECTOR() {
+
+	std::cout << std::endl;
+	std::cout << "-----------------------" << std::endl;
+	std::cout << "BENCHMARK_MATRIX_VECTOR" << std::endl;
+	std::cout << "-----------------------" << std::endl;
+
+	Matrix44 A(90.0, 73.0, 3.0, 4.0, 1.0, 16.0, 7.0, 8.0, 1.0, 3.0, 19.0, 81.0, 2.0, 1.0, 101.0, 15.0);
+	Matrix44ColumnMajor B;
+	convert(B, A);
+	Vector4 x(1.0, 2.0, 3.0, 4.0);
+	Vector4 y;
+
+	std::cout << std::endl << "Time for Matrix44: " << std::endl;
+	{
+		Timer timer;
+		for (int i = 0; i < 10000000; i++) {
+			multiply(y, A, x);
+		}
+	}
+
+	std::cout << std::endl << "Time for Matrix44ColumnMajor: " << std::endl;
+	{
+		Timer timer;
+		for (int i = 0; i < 10000000; i++) {
+			multiply(y, B, x);
+		}
+	}
+
+}
+
+void BENCHMARK_TELEMETRY() {
+
+	std::cout << std::endl;
+	std::cout << "-----------------------" << std::endl;
+	std::cout << "BENCHMARK_TELEMETRY" << std::endl;
+	std::cout << "-----------------------" << std::endl;
+
+	// Build with and without MATHEMATICS_ENGINE_TELEMETRY to compare the per call overhead
+	// Single matrix and vector kernels are not instrumented, a small batch shows the per call cost
+	std::cout << std::endl << "Time for Matrix44 times 16 Vector4 (telemetry " << (telemetry_enabled() ? "on" : "off") << "): " << std::endl;
+	{
+		Matrix44 A(90.0, 73.0, 3.0, 4.0, 1.0, 16.0, 7.0, 8.0, 1.0, 3.0, 19.0, 81.0, 2.0, 1.0, 101.0, 15.0);
+		Vector4 x[16];
+		Vector4 y[16];
+		Timer timer;
+		for (int i = 0; i < 1000000; i++) {
+			multiply_batch(y, A, x, 16);
+		}
+	}
+
+	if (telemetry_enabled()) {
+		std::cout << std::endl;
+		telemetry_export(std::cout);
+	}
+
 }
\ No newline at end of file
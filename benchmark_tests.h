@@ -12,5 +12,21 @@ void BENCHMARK_MATRIX_SCALAR_MULT();
 
 void BENCHMARK_MATRIX_TRANSPOSE();
 
+void BENCHMARK_MATRIX_VECTOR();
+
 void BENCHMARK_VECTOR_DOT();
+
+void BENCHMARK_VECTOR_NORMALIZE();
+
+void BENCHMARK_VECTOR3();
+
+void BENCHMARK_PIPELINE();
+
+void BENCHMARK_PROJECTION();
+
+void BENCHMARK_SKINNING();
+
+void BENCHMARK_REDUCTION();
+
+void BENCHMARK_TELEMETRY();
 #endif // BENCHMARK_TESTS_H_
\ No newline at end of file
@@ -11,6 +11,14 @@ int main() {
 	BENCHMARK_MATRIX_INVERSE();
 	BENCHMARK_MATRIX_SCALAR_MULT();
 	BENCHMARK_MATRIX_TRANSPOSE();
+	BENCHMARK_MATRIX_VECTOR();
 	BENCHMARK_VECTOR_DOT();
+	BENCHMARK_VECTOR_NORMALIZE();
+	BENCHMARK_VECTOR3();
+	BENCHMARK_PIPELINE();
+	BENCHMARK_PROJECTION();
+	BENCHMARK_SKINNING();
+	BENCHMARK_REDUCTION();
+	BENCHMARK_TELEMETRY();
 	return 1;
 }
\ No newline at end of file